@@ -0,0 +1,42 @@
+#ifndef _LTE_CRC_
+#define _LTE_CRC_
+
+#include <stdint.h>
+
+/*
+ * 3GPP TS 36.212 Release 8, 5.1.1 "CRC calculation"
+ *
+ * LTE_CRC24A - Transport block CRC
+ * LTE_CRC24B - Code block CRC of segmented transport blocks
+ * LTE_CRC16  - Control information CRC
+ * LTE_CRC8   - Control information CRC
+ */
+enum lte_crc_type {
+	LTE_CRC24A,
+	LTE_CRC24B,
+	LTE_CRC16,
+	LTE_CRC8,
+};
+
+/*
+ * All routines operate on 'len' packed bytes with the first bit in the most
+ * significant position. Parity bits follow the data in the same order.
+ */
+
+/* CRC remainder, zero over data followed by its parity bits */
+uint32_t lte_crc(int type, const uint8_t *in, int len);
+
+/*
+ * Append parity bits after 'len' bytes of data. Returns the length with
+ * parity bits in bytes or a negative value on error.
+ */
+int lte_crc_attach(int type, uint8_t *data, int len);
+
+/*
+ * Check 'len' bytes of data with parity bits attached, where 'len' includes
+ * the parity bits, i.e. the length returned by lte_crc_attach(). Returns 1
+ * if the check passes, 0 if it fails or a negative value on error.
+ */
+int lte_crc_check(int type, const uint8_t *data, int len);
+
+#endif /* _LTE_CRC_ */
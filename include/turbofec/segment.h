@@ -0,0 +1,52 @@
+#ifndef _LTE_SEGMENT_
+#define _LTE_SEGMENT_
+
+#include <stdint.h>
+
+/*
+ * Code block segmentation
+ *
+ * 3GPP TS 36.212 Release 8, 5.1.2 "Code block segmentation and code block
+ * CRC attachment". A transport block of 'len' bits, followed by its CRC24A
+ * parity bits, is split into 'num' code blocks. The first 'num_minus' code
+ * blocks are of length 'k_minus', the remaining 'num_plus' of 'k_plus'.
+ * The first code block starts with 'filler' zero filler bits. With more
+ * than one code block, each ends with CRC24B parity bits.
+ *
+ * Transport block lengths are multiples of 8, so that all code block
+ * boundaries fall on bytes. Code blocks are packed like the transport
+ * block with the first bit in the most significant position.
+ */
+struct lte_segment {
+	int len;
+	int num;
+	int num_minus;
+	int k_minus;
+	int num_plus;
+	int k_plus;
+	int filler;
+};
+
+/* Segmentation of a 'len' bit transport block */
+int lte_segment_init(struct lte_segment *seg, int len);
+
+/* Length of code block 'r' in bits */
+int lte_segment_len(const struct lte_segment *seg, int r);
+
+/*
+ * Attach the transport block CRC to 'in' and split into code blocks 'cb'
+ * with filler bits and code block CRCs. Returns the number of code blocks
+ * or a negative value on error.
+ */
+int lte_segment(const struct lte_segment *seg, const uint8_t *in,
+		uint8_t *const *cb);
+
+/*
+ * Reassemble the transport block from code blocks 'cb' into 'out' without
+ * filler and parity bits. Returns 1 if the transport block CRC check
+ * passes, 0 if it fails or a negative value on error.
+ */
+int lte_desegment(const struct lte_segment *seg, const uint8_t *const *cb,
+		  uint8_t *out);
+
+#endif /* _LTE_SEGMENT_ */
@@ -30,12 +30,236 @@ struct lte_turbo_code {
 	unsigned gen;
 };
 
+/*
+ * Code block descriptor for multi-block decoding
+ *
+ * d0, d1, d2 - Soft systematic and parity inputs (length len + 4)
+ * output     - Packed hard decision output (length len / 8)
+ */
+struct lte_turbo_block {
+	const int8_t *d0;
+	const int8_t *d1;
+	const int8_t *d2;
+	uint8_t *output;
+};
+
+/*
+ * TTI code block
+ *
+ * len        - Code block length
+ * d0, d1, d2 - Soft systematic and parity inputs (length len + 4)
+ * output     - Packed hard decision output (length len / 8)
+ * iter       - Number of iterations run, set by the decoder
+ * status     - Decoding status, set by the decoder
+ */
+struct lte_turbo_tti_block {
+	int len;
+	const int8_t *d0;
+	const int8_t *d1;
+	const int8_t *d2;
+	uint8_t *output;
+	int iter;
+	int status;
+};
+
+/*
+ * TTI code block status
+ *
+ * TDEC_BLOCK_CONVERGED - An early termination check passed
+ * TDEC_BLOCK_MAX_ITER  - All iterations run without passing a check
+ * TDEC_BLOCK_BUDGET    - Stopped by the TTI iteration or time budget
+ */
+enum tdec_block_status {
+	TDEC_BLOCK_CONVERGED,
+	TDEC_BLOCK_MAX_ITER,
+	TDEC_BLOCK_BUDGET,
+};
+
+/*
+ * Transport block for pool decoding
+ *
+ * num        - Number of code blocks
+ * iter       - Max number of iterations per code block
+ * prio       - Scheduling priority, higher values are decoded first
+ * blk        - Code blocks, iteration count and status are set by the decoder
+ * failed     - Number of code blocks that did not pass an early termination
+ *              check, set by the decoder
+ * done       - Completion callback or NULL, called once all code blocks of
+ *              the transport block are decoded, on the thread that decoded
+ *              the last one
+ * arg        - Completion callback argument
+ */
+struct lte_turbo_tb {
+	int num;
+	int iter;
+	int prio;
+	struct lte_turbo_tti_block *blk;
+	int failed;
+	void (*done)(struct lte_turbo_tb *tb, void *arg);
+	void *arg;
+};
+
+/* Min sliding window length */
+#define TDEC_MIN_WINDOW		16
+
+/* Max number of parallel trellis segments */
+#define TDEC_MAX_PARALLEL	16
+
+/* Max input soft value scale of the log-MAP kernel */
+#define TDEC_MAX_LLR_UNIT	64
+
+/* Max step of 8-bit exchanged L-values */
+#define TDEC_MAX_LVAL8		64
+
+/*
+ * Decoder options
+ *
+ * TDEC_OPT_KERNEL - Recursion kernel used for single code block decoding
+ * TDEC_OPT_WINDOW - Sliding window length in trellis steps, multiple of 8,
+ *                   or 0 to disable windowing (default). Decoder metric
+ *                   memory is sized to the window length.
+ * TDEC_OPT_TRAIN  - Backward training length at window boundaries. With 0
+ *                   (default), boundaries are initialized with backward
+ *                   metrics from the previous iteration.
+ * TDEC_OPT_PARALLEL - Number of trellis segments decoded concurrently on
+ *                     separate threads, 1 (default) to TDEC_MAX_PARALLEL.
+ *                     Segment boundaries are initialized with metrics from
+ *                     the previous iteration.
+ * TDEC_OPT_CRC      - Code block CRC checked on the hard decisions after
+ *                     each half-iteration. Decoding stops early once the
+ *                     check passes. The last 24 bits of the code block
+ *                     hold the CRC parity bits.
+ * TDEC_OPT_AGREE    - Stop early once the hard decisions of both
+ *                     constituent decoders agree (1) or never (0, default).
+ * TDEC_OPT_MIN_LVAL - Stop early once the smallest L-value magnitude of the
+ *                     code block exceeds this threshold, or never with 0
+ *                     (default).
+ * TDEC_OPT_SCALE    - Extrinsic scaling factor in sixteenths, 1 to 16
+ *                     (default, unscaled). Factors of 12 to 13 (0.75 to
+ *                     0.8125) compensate the max-log-MAP overestimate and
+ *                     reduce the number of iterations needed. Extrinsic
+ *                     soft output is returned scaled.
+ * TDEC_OPT_LLR_UNIT - Scale of the input soft values in steps per nat of
+ *                     channel log-likelihood ratio, 1 to TDEC_MAX_LLR_UNIT
+ *                     (default 16). Sets the correction term of the log-MAP
+ *                     kernel and has no effect on other kernels.
+ * TDEC_OPT_SHUFFLE  - Run both constituent decoders concurrently on two
+ *                     threads (1) instead of one after the other (0,
+ *                     default). Each decoder uses the extrinsic output of
+ *                     the other at window boundaries, which halves the
+ *                     latency of an iteration. Requires windowed recursions,
+ *                     see TDEC_OPT_WINDOW. Trades error rate for latency:
+ *                     an iteration gains less than a serial iteration, so
+ *                     the error rate is higher for the same number of
+ *                     iterations. Output is not deterministic, the same
+ *                     input may decode differently from call to call with
+ *                     thread timing. Does not apply to the 8-bit kernel or
+ *                     with parallel segments.
+ * TDEC_OPT_LVAL8    - Exchange L-values between the constituent decoders
+ *                     as saturated 8-bit values in steps of 'val', a power
+ *                     of two up to TDEC_MAX_LVAL8, or 0 for 16-bit values
+ *                     (default). Halves the footprint of the interleaved
+ *                     accesses while recursions remain 16-bit. Steps of 4
+ *                     to 16 perform close to 16-bit exchange. Applies to
+ *                     serial decoding with the 16-bit kernels only.
+ * TDEC_OPT_INT8_ITER - Number of initial iterations run with the 8-bit
+ *                     kernel before switching to the selected 16-bit kernel
+ *                     (default 0). L-values are rescaled at the switch.
+ *                     Recovers most of the 8-bit kernel loss while at
+ *                     least half of the iterations are 16-bit. Applies to
+ *                     serial decoding with the 16-bit kernels only.
+ */
+enum tdec_opt {
+	TDEC_OPT_KERNEL,
+	TDEC_OPT_WINDOW,
+	TDEC_OPT_TRAIN,
+	TDEC_OPT_PARALLEL,
+	TDEC_OPT_CRC,
+	TDEC_OPT_AGREE,
+	TDEC_OPT_MIN_LVAL,
+	TDEC_OPT_SCALE,
+	TDEC_OPT_LLR_UNIT,
+	TDEC_OPT_SHUFFLE,
+	TDEC_OPT_LVAL8,
+	TDEC_OPT_INT8_ITER,
+};
+
+/*
+ * Recursion kernels
+ *
+ * TDEC_KERNEL_RADIX2 - One trellis stage per step (default)
+ * TDEC_KERNEL_RADIX4 - Two trellis stages merged per step. Hard decisions
+ *                      match the radix-2 kernel. Soft output differs once
+ *                      path metrics saturate.
+ * TDEC_KERNEL_INT8   - 8-bit metrics with two trellis segments decoded per
+ *                      step. Higher throughput at a loss of roughly 0.1-0.2
+ *                      dB. Window and parallel options do not apply and
+ *                      L-values are on a reduced scale.
+ * TDEC_KERNEL_LOGMAP - Radix-2 log-MAP with the Jacobian correction term
+ *                      taken from a table. Gains roughly 0.2-0.3 dB over
+ *                      max-log-MAP at about twice the cost per step.
+ *                      Requires input soft values of known scale, see
+ *                      TDEC_OPT_LLR_UNIT. Overstating the scale performs
+ *                      worse than max-log-MAP.
+ * TDEC_KERNEL_XSCHED - Radix-2 with forward and backward recursions run
+ *                      concurrently from opposite ends of each window.
+ *                      Two independent dependency chains per step for
+ *                      superscalar cores. Output matches the radix-2 kernel
+ *                      apart from the normalization of backward metrics
+ *                      carried across window and segment boundaries.
+ * TDEC_KERNEL_MODULO - Radix-2 with wrapping metrics in place of per-step
+ *                      normalization, which shortens the dependency chain
+ *                      of both recursions. A-priori L-values are clipped
+ *                      to a magnitude of 2048, so soft and extrinsic output
+ *                      differ from the radix-2 kernel.
+ */
+enum tdec_kernel {
+	TDEC_KERNEL_RADIX2,
+	TDEC_KERNEL_RADIX4,
+	TDEC_KERNEL_INT8,
+	TDEC_KERNEL_LOGMAP,
+	TDEC_KERNEL_XSCHED,
+	TDEC_KERNEL_MODULO,
+};
+
+/*
+ * Early termination checks
+ *
+ * TDEC_CRC_NONE - Always run all iterations (default)
+ * TDEC_CRC_24A  - Transport block CRC of single code block transport blocks
+ * TDEC_CRC_24B  - Code block CRC of segmented transport blocks
+ */
+enum tdec_crc {
+	TDEC_CRC_NONE,
+	TDEC_CRC_24A,
+	TDEC_CRC_24B,
+};
+
 struct tdecoder *alloc_tdec();
 void free_tdec(struct tdecoder *dec);
+int tdec_set_opt(struct tdecoder *dec, int opt, int val);
+
+/*
+ * Known bits of single code block decoding
+ *
+ * Marks bits 'start' to 'start + n - 1' of subsequently decoded code blocks
+ * as known, with values from 'bits' unpacked one per byte, or zero if
+ * 'bits' is NULL as for the filler bits of the first code block of a
+ * segmented transport block. Known bits accumulate over calls and are all
+ * cleared with 'n' of zero. Their systematic inputs are pinned to
+ * saturation in both constituent decoders and they are output as given.
+ */
+int tdec_set_known(struct tdecoder *dec, int start, int n,
+		   const uint8_t *bits);
 
 int lte_turbo_encode(const struct lte_turbo_code *code,
 		   const uint8_t *input, uint8_t *d0, uint8_t *d1, uint8_t *d2);
 
+/*
+ * Single code block decoding returns the number of iterations run, which is
+ * less than 'iter' with early termination, or a negative value on error.
+ */
+
 /* Packed output */
 int lte_turbo_decode(struct tdecoder *dec, int len, int iter, uint8_t *output,
 		     const int8_t *d0, const int8_t *d1, const int8_t *d2);
@@ -45,4 +269,106 @@ int lte_turbo_decode_unpack(struct tdecoder *dec, int len, int iter,
 			    uint8_t *output, const int8_t *d0,
 			    const int8_t *d1, const int8_t *d2);
 
+/*
+ * Soft output, a-posteriori and extrinsic L-values in 'app' and 'ext',
+ * either of which may be NULL. Positive values indicate a 1 bit. Values
+ * depend on the kernel, e.g. the modulo kernel clips a-priori values and
+ * its output differs from the radix-2 kernel.
+ */
+int lte_turbo_decode_soft(struct tdecoder *dec, int len, int iter,
+			  int16_t *app, int16_t *ext, const int8_t *d0,
+			  const int8_t *d1, const int8_t *d2);
+
+/*
+ * Packed output, warm started for HARQ retransmissions. L-values in
+ * 'lvals' are the initial a-priori input of the first constituent decoder
+ * and are replaced with its a-priori input for a further iteration. That is
+ * the extrinsic output of the second constituent decoder, or, if early
+ * termination stopped decoding after the first constituent decoder, the
+ * input that decoder started from. Known bits are saved as decoded, not as
+ * their pinned output values. Start the first transmission of
+ * a code block from zero and pass the same values to each retransmission,
+ * along with the combined soft inputs. Values are only valid for decoders
+ * with the same kernel and extrinsic scaling. The modulo kernel clips the
+ * initial values to a magnitude of 2048, and its extrinsic output differs
+ * from the radix-2 kernel. With early termination, a retransmission
+ * typically completes in one or two iterations.
+ */
+int lte_turbo_decode_harq(struct tdecoder *dec, int len, int iter,
+			  uint8_t *output, int16_t *lvals, const int8_t *d0,
+			  const int8_t *d1, const int8_t *d2);
+
+/*
+ * Multiple code block decoding uses default options regardless of the
+ * options set on the decoder, i.e. full length radix-2 recursions without
+ * early termination, known bits or extrinsic scaling.
+ */
+
+/*
+ * Packed output, two code blocks of equal length. Returns the number of
+ * iterations run, always 'iter', or a negative value on error.
+ */
+int lte_turbo_decode2(struct tdecoder *dec, int len, int iter,
+		      struct lte_turbo_block *blk);
+
+/* Packed output, n code blocks of equal length */
+int lte_turbo_decode_batch(struct tdecoder *dec, int n, int len, int iter,
+			   struct lte_turbo_block *blk);
+
+/*
+ * Packed output, n code blocks of a TTI with up to 'iter' iterations per
+ * block. Iterations are handed out in rounds to blocks that have not passed
+ * an early termination check, until 'budget' half-iterations or 'usec'
+ * microseconds are used. Zero disables either limit. Returns the number of
+ * half-iterations run, or -EINVAL if mixed precision, known bits or shuffled
+ * decoding are set on the decoder. Parallel segment decoding is ignored.
+ * Iteration state of about 55 kB per code block is kept in the decoder.
+ */
+int lte_turbo_decode_tti(struct tdecoder *dec, int n, int iter,
+			 int budget, int usec,
+			 struct lte_turbo_tti_block *blk);
+
+/*
+ * Constituent decoder (SISO)
+ *
+ * A single max-log-MAP pass over one LTE recursive systematic code of 'len'
+ * steps, for iterative receivers built outside of the turbo decoder. Takes
+ * systematic and parity soft inputs 'x' and 'z', and a-priori L-values
+ * 'apri' in trellis order, which may be NULL for none. Extrinsic L-values
+ * are written to 'ext', which may alias 'apri'. With 'term' set, the
+ * trellis ends in the zero state and 'x' and 'z' hold 3 additional tail
+ * steps. Otherwise, all end states are equally likely.
+ *
+ * L-values are on twice the scale of the soft inputs, such that the
+ * a-posteriori value is 2 * x + apri + ext, and extrinsic scaling of the
+ * decoder applies. The kernel, window and training options of the decoder
+ * are used. The 8-bit kernel is not supported. Returns 0 or a negative
+ * value on error.
+ */
+int lte_turbo_siso(struct tdecoder *dec, int len, int term,
+		   const int8_t *x, const int8_t *z,
+		   const int16_t *apri, int16_t *ext);
+
+/*
+ * Decoder pool
+ *
+ * A fixed pool of threads, including the calling thread, each with its own
+ * decoder. Decoder options are applied to all decoders of the pool, except
+ * for parallel segment and shuffled decoding, which are not supported.
+ */
+struct tdec_pool;
+
+struct tdec_pool *alloc_tdec_pool(int num);
+void free_tdec_pool(struct tdec_pool *pool);
+int tdec_pool_set_opt(struct tdec_pool *pool, int opt, int val);
+
+/*
+ * Packed output, all code blocks of n transport blocks decoded on the pool.
+ * Code blocks are distributed by priority and length, and idle threads
+ * steal blocks from busy ones. Returns the number of code blocks that did
+ * not pass an early termination check or a negative value on error.
+ */
+int lte_turbo_decode_tb(struct tdec_pool *pool, int n,
+			struct lte_turbo_tb *tb);
+
 #endif /* _LTE_TURBO_ */
@@ -0,0 +1,87 @@
+/*
+ * LTE CRC table generator
+ *
+ * Copyright (C) 2015 Ettus Research LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Tom Tsou <tom.tsou@ettus.com>
+ */
+
+
+/*
+ * Writes the slicing-by-8 tables of all CRC types as a constant table to
+ * standard output.
+ *
+ * The shift register is held in the upper bits of 32, so that all CRC
+ * widths share the same update. Table 'n' holds the register contribution
+ * of a byte followed by 'n' zero bytes.
+ */
+#include <stdio.h>
+#include <stdint.h>
+
+#include "turbo_crc.h"
+
+#define VALS_PER_LINE		4
+
+static void gen_tables(const struct lte_crc_param *param,
+		       uint32_t (*table)[256])
+{
+	int i, n;
+	uint32_t crc, poly = param->poly << (32 - param->width);
+
+	for (i = 0; i < 256; i++) {
+		crc = (uint32_t) i << 24;
+		for (n = 0; n < 8; n++)
+			crc = crc & 0x80000000 ? (crc << 1) ^ poly : crc << 1;
+
+		table[0][i] = crc;
+	}
+
+	for (n = 1; n < 8; n++) {
+		for (i = 0; i < 256; i++) {
+			crc = table[n - 1][i];
+			table[n][i] = (crc << 8) ^ table[0][crc >> 24];
+		}
+	}
+}
+
+int main(void)
+{
+	int i, n, t;
+	uint32_t table[8][256];
+
+	printf("/* Generated by gen_crc - do not edit */\n\n");
+	printf("#include <stdint.h>\n\n");
+	printf("static const uint32_t crc_tables[NUM_CRC][8][256] = {");
+
+	for (t = 0; t < NUM_CRC; t++) {
+		gen_tables(&crc_params[t], table);
+
+		printf("\n\t{");
+		for (n = 0; n < 8; n++) {
+			printf("\n\t\t{");
+			for (i = 0; i < 256; i++) {
+				printf(i % VALS_PER_LINE ? " " : "\n\t\t\t");
+				printf("0x%08x,", table[n][i]);
+			}
+			printf("\n\t\t},");
+		}
+		printf("\n\t},");
+	}
+
+	printf("\n};\n");
+
+	return 0;
+}
@@ -0,0 +1,104 @@
+/*
+ * LTE turbo interleaver table generator
+ *
+ * Copyright (C) 2015 Ettus Research LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Tom Tsou <tom.tsou@ettus.com>
+ */
+
+
+/*
+ * Writes the interleaver and de-interleaver maps of all block sizes as
+ * constant tables to standard output. Maps of all sizes are concatenated
+ * and located through offsets indexed like the interleaver parameters.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "turbo_qpp.h"
+
+#define VALS_PER_LINE		8
+
+static void gen_maps(uint16_t *pi, uint16_t *inv)
+{
+	int i, n, k, p, f1, f2, len = 0;
+
+	for (i = 1; i < MAX_I; i++) {
+		k = lte_interlv_params[i].k;
+		f1 = lte_interlv_params[i].f1;
+		f2 = lte_interlv_params[i].f2;
+
+		for (n = 0; n < k; n++) {
+			p = n * (f1 % k + f2 * n % k) % k;
+			pi[len + n] = p;
+			inv[len + p] = n;
+		}
+
+		len += k;
+	}
+}
+
+static void print_map(const char *name, const uint16_t *map, int len)
+{
+	int i;
+
+	printf("static const uint16_t %s[%i] = {", name, len);
+
+	for (i = 0; i < len; i++) {
+		printf(i % VALS_PER_LINE ? " " : "\n\t");
+		printf("%u,", map[i]);
+	}
+
+	printf("\n};\n\n");
+}
+
+int main(void)
+{
+	int i, len = 0;
+	uint16_t *pi, *inv;
+
+	for (i = 1; i < MAX_I; i++)
+		len += lte_interlv_params[i].k;
+
+	pi = (uint16_t *) malloc(len * sizeof(uint16_t));
+	inv = (uint16_t *) malloc(len * sizeof(uint16_t));
+	if (!pi || !inv)
+		return 1;
+
+	gen_maps(pi, inv);
+
+	printf("/* Generated by gen_qpp - do not edit */\n\n");
+	printf("#include <stdint.h>\n\n");
+
+	print_map("lte_deinterlv_tbl", pi, len);
+	print_map("lte_interlv_tbl", inv, len);
+
+	/* Index 0 is unused */
+	printf("static const uint32_t lte_interlv_ofs[MAX_I] = {");
+	for (i = 0, len = 0; i < MAX_I; i++) {
+		printf(i % VALS_PER_LINE ? " " : "\n\t");
+		printf("%i,", len);
+		if (i)
+			len += lte_interlv_params[i].k;
+	}
+	printf("\n};\n");
+
+	free(pi);
+	free(inv);
+
+	return 0;
+}
@@ -0,0 +1,180 @@
+/*
+ * LTE Max-Log-MAP turbo decoder - AVX2 paired recursions
+ *
+ * Copyright (C) 2015 Ettus Research LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Tom Tsou <tom.tsou@ettus.com>
+ */
+
+#ifdef HAVE_AVX2
+#include <stdint.h>
+#include <immintrin.h>
+
+/*
+ * Paired recursions
+ *
+ * Same recursions as the SSE version, but each 256-bit register carries the
+ * 8 trellis states of two independent code blocks - the first block in the
+ * low 128-bit lane and the second block in the high 128-bit lane. AVX2 byte
+ * shuffles, unpacks, and shifts operate within 128-bit lanes, so the SSE
+ * shuffle masks are repeated for each lane and the blocks never mix.
+ *
+ * Inputs are stored as interleaved 16-bit pairs. Systematic and parity
+ * values for a single step are packed as (x0, x1, z0, z1) and L-values as
+ * (l0, l1).
+ */
+#define PAIR_LO_MASK \
+	3, 2, 3, 2, 3, 2, 3, 2, 3, 2, 3, 2, 3, 2, 3, 2, \
+	1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0
+#define PAIR_HI_MASK \
+	7, 6, 7, 6, 7, 6, 7, 6, 7, 6, 7, 6, 7, 6, 7, 6, \
+	5, 4, 5, 4, 5, 4, 5, 4, 5, 4, 5, 4, 5, 4, 5, 4
+#define PAIR_BCAST_MASK \
+	1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, \
+	1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0
+
+/* Broadcast a (lane 0, lane 1) pair of 16-bit values across each lane */
+static inline __m256i pair_bcast(const int16_t *p)
+{
+	__m256i m0;
+
+	m0 = _mm256_set1_epi32(*(const int32_t *) p);
+	return _mm256_shuffle_epi8(m0, _mm256_set_epi8(PAIR_LO_MASK));
+}
+
+/* Gather the low 16-bit element of each lane into a packed pair */
+static inline void pair_store(int16_t *p, __m256i m)
+{
+	__m128i m0, m1;
+
+	m0 = _mm256_castsi256_si128(m);
+	m1 = _mm256_extracti128_si256(m, 1);
+	m0 = _mm_blend_epi16(m0, _mm_slli_si128(m1, 2), 0x02);
+
+	*(int32_t *) p = _mm_cvtsi128_si32(m0);
+}
+
+static inline void gen_fw_metrics2(int16_t *bm, const int16_t *xz,
+				   const int16_t *le, int16_t *sums_p,
+				   int16_t *sums_c, int16_t *norm)
+{
+	__m256i m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13;
+
+	m3 = _mm256_broadcastq_epi64(_mm_loadl_epi64((__m128i *) xz));
+	m0 = _mm256_shuffle_epi8(m3, _mm256_set_epi8(PAIR_LO_MASK));
+	m1 = _mm256_shuffle_epi8(m3, _mm256_set_epi8(PAIR_HI_MASK));
+	m2 = pair_bcast(le);
+	m3 = _mm256_setzero_si256();
+	m4 = _mm256_set_epi16(LTE_SYSTEM_FW_SHUFFLE, LTE_SYSTEM_FW_SHUFFLE);
+	m5 = _mm256_set_epi16(LTE_PARITY_FW_SHUFFLE, LTE_PARITY_FW_SHUFFLE);
+
+	/* Branch metrics */
+	m6 = _mm256_sign_epi16(m0, m4);
+	m7 = _mm256_sign_epi16(m1, m5);
+	m8 = _mm256_sign_epi16(m2, m4);
+	m8 = _mm256_srai_epi16(m8, 1);
+
+	m6 = _mm256_adds_epi16(m6, m7);
+	m6 = _mm256_adds_epi16(m6, m8);
+	m7 = _mm256_subs_epi16(m3, m6);
+
+	/* Pre-interleave for backward recursion */
+	m8 = _mm256_unpacklo_epi16(m6, m7);
+	_mm256_store_si256((__m256i *) bm, m8);
+
+	/* Forward metrics */
+	m9  = _mm256_load_si256((__m256i *) sums_p);
+	m10 = _mm256_set_epi8(FW_SHUFFLE_MASK0, FW_SHUFFLE_MASK0);
+	m11 = _mm256_set_epi8(FW_SHUFFLE_MASK1, FW_SHUFFLE_MASK1);
+
+	m12 = _mm256_shuffle_epi8(m9, m10);
+	m13 = _mm256_shuffle_epi8(m9, m11);
+	m12 = _mm256_adds_epi16(m12, m6);
+	m13 = _mm256_adds_epi16(m13, m7);
+
+	m0 = _mm256_max_epi16(m12, m13);
+	m1 = _mm256_shuffle_epi8(m0, _mm256_set_epi8(PAIR_BCAST_MASK));
+	m0 = _mm256_subs_epi16(m0, m1);
+
+	_mm256_store_si256((__m256i *) sums_c, m0);
+	pair_store(norm, m1);
+}
+
+/*
+ * Paired horizontal maximum
+ *
+ * Reduce the 8 elements of each 128-bit lane in M0 and M1 and return the
+ * lane-wise difference max(M1) - max(M0) in the low element of each lane.
+ */
+static inline __m256i pair_maxdiff(__m256i m0, __m256i m1)
+{
+	__m256i m2, m3;
+
+	m2 = _mm256_unpacklo_epi64(m0, m1);
+	m3 = _mm256_unpackhi_epi64(m0, m1);
+	m2 = _mm256_max_epi16(m2, m3);
+	m3 = _mm256_shuffle_epi32(m2, _MM_SHUFFLE(2, 3, 0, 1));
+	m2 = _mm256_max_epi16(m2, m3);
+	m3 = _mm256_shufflelo_epi16(m2, _MM_SHUFFLE(2, 3, 0, 1));
+	m3 = _mm256_shufflehi_epi16(m3, _MM_SHUFFLE(2, 3, 0, 1));
+	m2 = _mm256_max_epi16(m2, m3);
+	m3 = _mm256_srli_si256(m2, 8);
+
+	return _mm256_sub_epi16(m3, m2);
+}
+
+static inline void gen_bw_metrics2(int16_t *bm, const int16_t *xz,
+				   int16_t *fw, int16_t *bw,
+				   const int16_t *norm, int16_t *lv)
+{
+	__m256i m0, m1, m3, m4, m5, m6, m9, m10, m11, m12, m13;
+
+	m0 = _mm256_broadcastq_epi64(_mm_loadl_epi64((__m128i *) xz));
+	m0 = _mm256_shuffle_epi8(m0, _mm256_set_epi8(PAIR_HI_MASK));
+	m1 = _mm256_set_epi16(LTE_PARITY_BW_SHUFFLE, LTE_PARITY_BW_SHUFFLE);
+
+	/* Partial branch metrics */
+	m13 = _mm256_sign_epi16(m0, m1);
+
+	/* Backward metrics */
+	m0 = _mm256_load_si256((__m256i *) bw);
+	m1 = _mm256_load_si256((__m256i *) bm);
+	m6 = _mm256_load_si256((__m256i *) fw);
+	m3 = pair_bcast(norm);
+
+	m4 = _mm256_unpacklo_epi16(m0, m0);
+	m5 = _mm256_unpackhi_epi16(m0, m0);
+	m4 = _mm256_adds_epi16(m4, m1);
+	m5 = _mm256_subs_epi16(m5, m1);
+
+	m1 = _mm256_max_epi16(m4, m5);
+	m1 = _mm256_subs_epi16(m1, m3);
+	_mm256_store_si256((__m256i *) bw, m1);
+
+	/* L-values */
+	m9  = _mm256_set_epi8(LV_BW_SHUFFLE_MASK0, LV_BW_SHUFFLE_MASK0);
+	m10 = _mm256_set_epi8(LV_BW_SHUFFLE_MASK1, LV_BW_SHUFFLE_MASK1);
+	m9  = _mm256_shuffle_epi8(m0, m9);
+	m10 = _mm256_shuffle_epi8(m0, m10);
+
+	m11 = _mm256_adds_epi16(m6, m13);
+	m12 = _mm256_subs_epi16(m6, m13);
+	m11 = _mm256_adds_epi16(m11, m9);
+	m12 = _mm256_adds_epi16(m12, m10);
+
+	pair_store(lv, pair_maxdiff(m11, m12));
+}
+#endif /* HAVE_AVX2 */
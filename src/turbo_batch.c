@@ -0,0 +1,284 @@
+/*
+ * Max-Log-MAP LTE turbo decoder - Multiple code block batches
+ *
+ * Copyright (C) 2015 Ettus Research LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Tom Tsou <tom.tsou@ettus.com>
+ */
+
+#include <stdlib.h>
+#if !defined(__MACH__)
+#include <malloc.h>
+#endif
+#include <string.h>
+#include <errno.h>
+#include "turbofec/turbo.h"
+#include "turbo_int.h"
+#include "turbo_batch_sse.h"
+
+#ifdef HAVE_SSE3
+#define ALIGN		__attribute__((aligned(BATCH_ALIGN)))
+
+/*
+ * Batch Trellis Object
+ *
+ * All values are stored transposed with one row of BATCH_WIDTH code blocks
+ * for each trellis step.
+ *
+ * x       - Systematic inputs
+ * z       - Parity inputs
+ * lvals   - L-values
+ */
+struct btrellis {
+	ALIGN int8_t x[MAX_TRELLIS_LEN][BATCH_WIDTH];
+	ALIGN int8_t z[MAX_TRELLIS_LEN][BATCH_WIDTH];
+	ALIGN int16_t lvals[MAX_TRELLIS_LEN][BATCH_WIDTH];
+};
+
+/*
+ * Batch Turbo Decoder
+ *
+ * Forward metrics are stored as [step][state][block]. Branch metrics are
+ * not stored and are regenerated during the backward recursion.
+ *
+ * Storage is sized for the longest code block, about 5 MB with AVX-512,
+ * 2.6 MB with AVX2 and 1.3 MB with SSE. Groups that fill no more than half
+ * of an AVX-512 batch run on a separate 256-bit batch, which is allocated
+ * on first use.
+ *
+ * trellis  - Trellis objects for the two constituent decoders
+ * bwsums   - Backward metrics of the current step
+ * fwsums   - Forward metrics for all steps
+ * fwnorm   - Forward normalization values for all steps
+ * half     - 256-bit batch for half filled groups
+ * use_half - Last group was decoded by the 256-bit batch
+ */
+struct tbatch {
+	struct btrellis trellis[2];
+
+	bvec_t bwsums[NUM_TRELLIS_STATES];
+	bvec_t fwsums[MAX_TRELLIS_LEN + 1][NUM_TRELLIS_STATES];
+	bvec_t fwnorm[MAX_TRELLIS_LEN];
+#ifdef HAVE_AVX512_BW
+	struct tbatch256 *half;
+	int use_half;
+#endif
+};
+
+int tbatch_width()
+{
+	return BATCH_WIDTH;
+}
+
+struct tbatch *alloc_tbatch()
+{
+	struct tbatch *batch;
+
+#if defined(__MACH__)
+	if (posix_memalign((void **) &batch, BATCH_ALIGN,
+			   sizeof(struct tbatch)))
+		return NULL;
+#else
+	batch = (struct tbatch *) memalign(BATCH_ALIGN, sizeof(struct tbatch));
+	if (!batch)
+		return NULL;
+#endif
+#ifdef HAVE_AVX512_BW
+	batch->half = NULL;
+	batch->use_half = 0;
+#endif
+	return batch;
+}
+
+void free_tbatch(struct tbatch *batch)
+{
+#ifdef HAVE_AVX512_BW
+	if (batch)
+		free_tbatch256(batch->half);
+#endif
+	free(batch);
+}
+
+/*
+ * Constituent decoder iteration
+ *
+ * With 'map' set, a-priori values are read from, and extrinsic values are
+ * written to, the L-value rows 'lv' of the first decoder in interleaved
+ * order, which replaces separate interleaving passes over all rows. Tail
+ * steps beyond 'k' are not interleaved and use the rows of 'trellis'.
+ */
+static void batch_iterate(struct tbatch *batch, struct btrellis *trellis,
+			  int16_t (*lv)[BATCH_WIDTH], const uint16_t *map,
+			  int k, int len)
+{
+	int i;
+	int16_t *le;
+	int16_t init[BATCH_WIDTH];
+
+	for (i = 0; i < BATCH_WIDTH; i++)
+		init[i] = SUM_INIT;
+
+	batch->bwsums[0] = BV_LOAD(init);
+
+	/* Forward */
+	for (i = 0; i < len; i++) {
+		le = map && (i < k) ? lv[map[i]] : trellis->lvals[i];
+		batch_gen_fw(trellis->x[i], trellis->z[i], le,
+			     batch->fwsums[i], batch->fwsums[i + 1],
+			     &batch->fwnorm[i]);
+	}
+
+	/* Backward */
+	for (i = len - 1; i >= 0; i--) {
+		le = map && (i < k) ? lv[map[i]] : trellis->lvals[i];
+		batch_gen_bw(trellis->x[i], trellis->z[i], le,
+			     batch->fwsums[i], batch->bwsums,
+			     batch->fwnorm[i], le);
+	}
+}
+
+/*
+ * Load soft inputs of one code block into lane 'n' of the batch trellis.
+ * Termination is reversed on local copies so input buffers are untouched.
+ */
+static void load_lane(struct tbatch *batch, int len, int n,
+		      const struct lte_turbo_block *blk)
+{
+	int i;
+	int8_t d0[len + 4], d1[len + 4], d2[len + 4], d0p[len + 3];
+	struct btrellis *trellis = batch->trellis;
+
+	if (!blk) {
+		for (i = 0; i < len + 3; i++) {
+			trellis[0].x[i][n] = 0;
+			trellis[0].z[i][n] = 0;
+			trellis[1].x[i][n] = 0;
+			trellis[1].z[i][n] = 0;
+		}
+		return;
+	}
+
+	memcpy(d0, blk->d0, len + 4);
+	memcpy(d1, blk->d1, len + 4);
+	memcpy(d2, blk->d2, len + 4);
+
+	turbo_interleave(len, (uint8_t *) d0, (uint8_t *) d0p);
+	turbo_unterm(len, (uint8_t *) d0, (uint8_t *) d1,
+		     (uint8_t *) d2, (uint8_t *) d0p);
+
+	for (i = 0; i < len + 3; i++) {
+		trellis[0].x[i][n] = d0[i];
+		trellis[0].z[i][n] = d1[i];
+		trellis[1].x[i][n] = d0p[i];
+		trellis[1].z[i][n] = d2[i];
+	}
+}
+
+/*
+ * Decode up to BATCH_WIDTH code blocks of equal length
+ *
+ * Unused lanes are fed with zero inputs. Backward metrics are reset on each
+ * call, so results do not depend on previously decoded batches.
+ */
+int tbatch_decode(struct tbatch *batch, int len, int iter,
+		  const struct lte_turbo_block *blk, int n)
+{
+	int i;
+	const uint16_t *map;
+	struct btrellis *trellis = batch->trellis;
+	int16_t init[NUM_TRELLIS_STATES][BATCH_WIDTH];
+
+	if ((n < 1) || (n > BATCH_WIDTH))
+		return -EINVAL;
+
+#ifdef HAVE_AVX512_BW
+	batch->use_half = 2 * n <= BATCH_WIDTH;
+	if (batch->use_half) {
+		if (!batch->half) {
+			batch->half = alloc_tbatch256();
+			if (!batch->half)
+				return -ENOMEM;
+		}
+		return tbatch256_decode(batch->half, len, iter, blk, n);
+	}
+#endif
+	map = turbo_interleave_map(len);
+	if (!map)
+		return -EINVAL;
+
+	for (i = 0; i < BATCH_WIDTH; i++)
+		load_lane(batch, len, i, i < n ? &blk[i] : NULL);
+
+	memset(init, 0, sizeof(init));
+	for (i = 0; i < BATCH_WIDTH; i++)
+		init[0][i] = SUM_INIT;
+
+	for (i = 0; i < NUM_TRELLIS_STATES; i++) {
+		batch->fwsums[0][i] = BV_LOAD(init[i]);
+		batch->bwsums[i] = BV_ZERO();
+	}
+
+	memset(trellis[0].lvals, 0, (len + 3) * sizeof(trellis[0].lvals[0]));
+	memset(trellis[1].lvals, 0, (len + 3) * sizeof(trellis[1].lvals[0]));
+
+	for (i = 0; i < iter; i++) {
+		batch_iterate(batch, &trellis[0], NULL, NULL, len, len + 3);
+		batch_iterate(batch, &trellis[1], trellis[0].lvals, map,
+			      len, len + 3);
+	}
+
+	return 0;
+}
+
+/* Copy out L-values of lane 'n' */
+void tbatch_lvals(const struct tbatch *batch, int len, int n, int16_t *lvals)
+{
+	int i;
+
+#ifdef HAVE_AVX512_BW
+	if (batch->use_half) {
+		tbatch256_lvals(batch->half, len, n, lvals);
+		return;
+	}
+#endif
+	for (i = 0; i < len; i++)
+		lvals[i] = batch->trellis[0].lvals[i][n];
+}
+#else
+int tbatch_width()
+{
+	return 0;
+}
+
+struct tbatch *alloc_tbatch()
+{
+	return NULL;
+}
+
+void free_tbatch(struct tbatch *batch)
+{
+}
+
+int tbatch_decode(struct tbatch *batch, int len, int iter,
+		  const struct lte_turbo_block *blk, int n)
+{
+	return -ENOTSUP;
+}
+
+void tbatch_lvals(const struct tbatch *batch, int len, int n, int16_t *lvals)
+{
+}
+#endif /* HAVE_SSE3 */
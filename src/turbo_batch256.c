@@ -0,0 +1,38 @@
+/*
+ * Max-Log-MAP LTE turbo decoder - 256-bit batches on AVX-512 targets
+ *
+ * Copyright (C) 2015 Ettus Research LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Tom Tsou <tom.tsou@ettus.com>
+ */
+
+/*
+ * The batch decoder is built a second time with the AVX2 vector type, under
+ * separate names, for groups of up to 16 code blocks. A half filled 512-bit
+ * batch would otherwise run the recursions over twice the lanes in use.
+ */
+#ifdef HAVE_AVX512_BW
+#undef HAVE_AVX512_BW
+
+#define tbatch			tbatch256
+#define tbatch_width		tbatch256_width
+#define alloc_tbatch		alloc_tbatch256
+#define free_tbatch		free_tbatch256
+#define tbatch_decode		tbatch256_decode
+#define tbatch_lvals		tbatch256_lvals
+
+#include "turbo_batch.c"
+#endif
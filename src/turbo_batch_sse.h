@@ -0,0 +1,242 @@
+/*
+ * LTE Max-Log-MAP turbo decoder - SSE/AVX2/AVX-512 batch recursions
+ *
+ * Copyright (C) 2015 Ettus Research LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Tom Tsou <tom.tsou@ettus.com>
+ */
+
+#ifdef HAVE_SSE3
+#include <stdint.h>
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+/*
+ * Batch vector type
+ *
+ * The batch recursions use a transposed (state-major) layout. Each register
+ * holds one trellis state of BATCH_WIDTH independent code blocks, one block
+ * per 16-bit lane. All operations are vertical; there are no shuffles or
+ * horizontal reductions between lanes.
+ */
+#if defined(HAVE_AVX512_BW)
+#include <immintrin.h>
+
+#define BATCH_WIDTH		32
+#define BATCH_ALIGN		64
+
+typedef __m512i bvec_t;
+
+#define BV_LOAD8(P)	_mm512_cvtepi8_epi16(_mm256_load_si256((__m256i *) (P)))
+#define BV_LOAD(P)	_mm512_load_si512((void *) (P))
+#define BV_STORE(P,M)	_mm512_store_si512((void *) (P), M)
+#define BV_ZERO()	_mm512_setzero_si512()
+#define BV_SET1(X)	_mm512_set1_epi16(X)
+#define BV_ADD(A,B)	_mm512_add_epi16(A, B)
+#define BV_SUB(A,B)	_mm512_sub_epi16(A, B)
+#define BV_ADDS(A,B)	_mm512_adds_epi16(A, B)
+#define BV_SUBS(A,B)	_mm512_subs_epi16(A, B)
+#define BV_MAX(A,B)	_mm512_max_epi16(A, B)
+#define BV_SRAI(A,N)	_mm512_srai_epi16(A, N)
+#elif defined(HAVE_AVX2)
+#include <immintrin.h>
+
+#define BATCH_WIDTH		16
+#define BATCH_ALIGN		32
+
+typedef __m256i bvec_t;
+
+#define BV_LOAD8(P)	_mm256_cvtepi8_epi16(_mm_load_si128((__m128i *) (P)))
+#define BV_LOAD(P)	_mm256_load_si256((__m256i *) (P))
+#define BV_STORE(P,M)	_mm256_store_si256((__m256i *) (P), M)
+#define BV_ZERO()	_mm256_setzero_si256()
+#define BV_SET1(X)	_mm256_set1_epi16(X)
+#define BV_ADD(A,B)	_mm256_add_epi16(A, B)
+#define BV_SUB(A,B)	_mm256_sub_epi16(A, B)
+#define BV_ADDS(A,B)	_mm256_adds_epi16(A, B)
+#define BV_SUBS(A,B)	_mm256_subs_epi16(A, B)
+#define BV_MAX(A,B)	_mm256_max_epi16(A, B)
+#define BV_SRAI(A,N)	_mm256_srai_epi16(A, N)
+#else
+#define BATCH_WIDTH		8
+#define BATCH_ALIGN		16
+
+typedef __m128i bvec_t;
+
+#define BV_LOAD8(P) \
+	_mm_srai_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i *) (P)), \
+					 _mm_loadl_epi64((__m128i *) (P))), 8)
+#define BV_LOAD(P)	_mm_load_si128((__m128i *) (P))
+#define BV_STORE(P,M)	_mm_store_si128((__m128i *) (P), M)
+#define BV_ZERO()	_mm_setzero_si128()
+#define BV_SET1(X)	_mm_set1_epi16(X)
+#define BV_ADD(A,B)	_mm_add_epi16(A, B)
+#define BV_SUB(A,B)	_mm_sub_epi16(A, B)
+#define BV_ADDS(A,B)	_mm_adds_epi16(A, B)
+#define BV_SUBS(A,B)	_mm_subs_epi16(A, B)
+#define BV_MAX(A,B)	_mm_max_epi16(A, B)
+#define BV_SRAI(A,N)	_mm_srai_epi16(A, N)
+#endif
+
+/*
+ * Batch branch metrics
+ *
+ * Only four distinct branch metrics exist for each trellis step, one for
+ * each combination of systematic and parity output sign. These match the
+ * per-state values produced by the shuffled SSE recursion exactly.
+ *
+ * G[0] - Systematic -1, parity -1 (states 0, 7)
+ * G[1] - Systematic +1, parity -1 (states 1, 6)
+ * G[2] - Systematic -1, parity +1 (states 2, 5)
+ * G[3] - Systematic +1, parity +1 (states 3, 4)
+ */
+#define BATCH_GEN_BM(X,Z,LE,G) \
+{ \
+	bvec_t _nx, _nz, _ap, _an; \
+	_nx = BV_SUB(BV_ZERO(), X); \
+	_nz = BV_SUB(BV_ZERO(), Z); \
+	_ap = BV_SRAI(LE, 1); \
+	_an = BV_SRAI(BV_SUB(BV_ZERO(), LE), 1); \
+	G[0] = BV_ADDS(BV_ADDS(_nx, _nz), _an); \
+	G[1] = BV_ADDS(BV_ADDS(X, _nz), _ap); \
+	G[2] = BV_ADDS(BV_ADDS(_nx, Z), _an); \
+	G[3] = BV_ADDS(BV_ADDS(X, Z), _ap); \
+}
+
+/*
+ * Forward add-compare-select for state J entered from states 2(J % 4) and
+ * 2(J % 4) + 1 with branch metric G and its negation.
+ */
+#define BATCH_FW_ACS(J,FW,A,G) \
+{ \
+	A[J] = BV_MAX(BV_ADDS(FW[2 * (J % 4) + 0], G), \
+		      BV_ADDS(FW[2 * (J % 4) + 1], \
+			      BV_SUBS(BV_ZERO(), G))); \
+}
+
+/*
+ * Batch Forward Recursion
+ *
+ * Generate forward metrics (alpha) for one trellis step of BATCH_WIDTH code
+ * blocks. Metrics are normalized to state 0 and the normalization value is
+ * stored for the backward recursion.
+ */
+static inline void batch_gen_fw(const int8_t *x, const int8_t *z,
+				const int16_t *le, const bvec_t *fw_p,
+				bvec_t *fw_c, bvec_t *norm)
+{
+	bvec_t g[4], a[8];
+
+	BATCH_GEN_BM(BV_LOAD8(x), BV_LOAD8(z), BV_LOAD(le), g);
+
+	BATCH_FW_ACS(0, fw_p, a, g[0]);
+	BATCH_FW_ACS(1, fw_p, a, g[1]);
+	BATCH_FW_ACS(2, fw_p, a, g[2]);
+	BATCH_FW_ACS(3, fw_p, a, g[3]);
+	BATCH_FW_ACS(4, fw_p, a, g[3]);
+	BATCH_FW_ACS(5, fw_p, a, g[2]);
+	BATCH_FW_ACS(6, fw_p, a, g[1]);
+	BATCH_FW_ACS(7, fw_p, a, g[0]);
+
+	*norm = a[0];
+	fw_c[0] = BV_SUBS(a[0], a[0]);
+	fw_c[1] = BV_SUBS(a[1], a[0]);
+	fw_c[2] = BV_SUBS(a[2], a[0]);
+	fw_c[3] = BV_SUBS(a[3], a[0]);
+	fw_c[4] = BV_SUBS(a[4], a[0]);
+	fw_c[5] = BV_SUBS(a[5], a[0]);
+	fw_c[6] = BV_SUBS(a[6], a[0]);
+	fw_c[7] = BV_SUBS(a[7], a[0]);
+}
+
+/*
+ * Backward add-compare-select for state P leaving to states P / 2 and
+ * P / 2 + 4 with branch metric BM.
+ */
+#define BATCH_BW_ACS(P,BW,B,BM,N) \
+{ \
+	B[P] = BV_SUBS(BV_MAX(BV_ADDS(BW[P / 2 + 0], BM), \
+			      BV_SUBS(BW[P / 2 + 4], BM)), N); \
+}
+
+/*
+ * L-value terms for state P. Input bit 0 leaves to state C0 and input bit 1
+ * leaves to state C1. Only the parity contribution ZS is added to the sums so
+ * that the output is extrinsic.
+ */
+#define BATCH_LV_SUMS(P,FW,BW,ZS,C0,C1,M0,M1) \
+{ \
+	M0 = BV_ADDS(BV_ADDS(FW[P], ZS), BW[C0]); \
+	M1 = BV_ADDS(BV_SUBS(FW[P], ZS), BW[C1]); \
+}
+
+/*
+ * Batch Backward Recursion
+ *
+ * Generate backward metrics (beta) and L-values for one trellis step of
+ * BATCH_WIDTH code blocks. Branch metrics are regenerated from the inputs
+ * instead of being stored by the forward recursion. A single buffer holds
+ * the backward metrics, which are overwritten in place.
+ */
+static inline void batch_gen_bw(const int8_t *x, const int8_t *z,
+				const int16_t *le, const bvec_t *fw,
+				bvec_t *bw, bvec_t norm, int16_t *lv)
+{
+	bvec_t g[4], b[8], m0[8], m1[8], vx, vz, nz;
+
+	vx = BV_LOAD8(x);
+	vz = BV_LOAD8(z);
+	nz = BV_SUB(BV_ZERO(), vz);
+
+	BATCH_GEN_BM(vx, vz, BV_LOAD(le), g);
+
+	/* Backward metrics */
+	BATCH_BW_ACS(0, bw, b, g[0], norm);
+	BATCH_BW_ACS(1, bw, b, BV_SUBS(BV_ZERO(), g[0]), norm);
+	BATCH_BW_ACS(2, bw, b, g[1], norm);
+	BATCH_BW_ACS(3, bw, b, BV_SUBS(BV_ZERO(), g[1]), norm);
+	BATCH_BW_ACS(4, bw, b, g[2], norm);
+	BATCH_BW_ACS(5, bw, b, BV_SUBS(BV_ZERO(), g[2]), norm);
+	BATCH_BW_ACS(6, bw, b, g[3], norm);
+	BATCH_BW_ACS(7, bw, b, BV_SUBS(BV_ZERO(), g[3]), norm);
+
+	/* L-values */
+	BATCH_LV_SUMS(0, fw, bw, nz, 0, 4, m0[0], m1[0]);
+	BATCH_LV_SUMS(1, fw, bw, nz, 4, 0, m0[1], m1[1]);
+	BATCH_LV_SUMS(2, fw, bw, vz, 5, 1, m0[2], m1[2]);
+	BATCH_LV_SUMS(3, fw, bw, vz, 1, 5, m0[3], m1[3]);
+	BATCH_LV_SUMS(4, fw, bw, vz, 2, 6, m0[4], m1[4]);
+	BATCH_LV_SUMS(5, fw, bw, vz, 6, 2, m0[5], m1[5]);
+	BATCH_LV_SUMS(6, fw, bw, nz, 7, 3, m0[6], m1[6]);
+	BATCH_LV_SUMS(7, fw, bw, nz, 3, 7, m0[7], m1[7]);
+
+	m0[0] = BV_MAX(BV_MAX(BV_MAX(m0[0], m0[1]), BV_MAX(m0[2], m0[3])),
+		       BV_MAX(BV_MAX(m0[4], m0[5]), BV_MAX(m0[6], m0[7])));
+	m1[0] = BV_MAX(BV_MAX(BV_MAX(m1[0], m1[1]), BV_MAX(m1[2], m1[3])),
+		       BV_MAX(BV_MAX(m1[4], m1[5]), BV_MAX(m1[6], m1[7])));
+
+	BV_STORE(lv, BV_SUB(m1[0], m0[0]));
+
+	bw[0] = b[0];
+	bw[1] = b[1];
+	bw[2] = b[2];
+	bw[3] = b[3];
+	bw[4] = b[4];
+	bw[5] = b[5];
+	bw[6] = b[6];
+	bw[7] = b[7];
+}
+#endif /* HAVE_SSE3 */
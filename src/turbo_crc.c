@@ -0,0 +1,111 @@
+/*
+ * LTE cyclic redundancy checks
+ *
+ * Copyright (C) 2015 Ettus Research LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Tom Tsou <tom.tsou@ettus.com>
+ */
+
+#include <stdint.h>
+#include <errno.h>
+#include "turbofec/crc.h"
+#include "turbofec/turbo.h"
+#include "turbo_int.h"
+#include "turbo_crc.h"
+#include "turbo_crc_tables.h"
+
+#define API_EXPORT	__attribute__((__visibility__("default")))
+
+static inline uint32_t load_be32(const uint8_t *in)
+{
+	return ((uint32_t) in[0] << 24) | ((uint32_t) in[1] << 16) |
+	       ((uint32_t) in[2] << 8) | (uint32_t) in[3];
+}
+
+/*
+ * CRC remainder over 'len' bytes
+ *
+ * Slicing-by-8 over the tables generated by gen_crc. Bytes are processed
+ * with the first bit in the most significant position. With parity bits
+ * included in the input, a zero remainder indicates a passing check.
+ */
+API_EXPORT
+uint32_t lte_crc(int type, const uint8_t *in, int len)
+{
+	uint32_t crc = 0, next;
+	const uint32_t (*t)[256];
+
+	if ((type < 0) || (type >= NUM_CRC))
+		return 0;
+
+	t = crc_tables[type];
+
+	for (; len >= 8; len -= 8, in += 8) {
+		crc ^= load_be32(&in[0]);
+		next = load_be32(&in[4]);
+
+		crc = t[7][crc >> 24] ^ t[6][(crc >> 16) & 0xff] ^
+		      t[5][(crc >> 8) & 0xff] ^ t[4][crc & 0xff] ^
+		      t[3][next >> 24] ^ t[2][(next >> 16) & 0xff] ^
+		      t[1][(next >> 8) & 0xff] ^ t[0][next & 0xff];
+	}
+
+	for (; len > 0; len--, in++)
+		crc = (crc << 8) ^ t[0][(crc >> 24) ^ *in];
+
+	return crc >> (32 - crc_params[type].width);
+}
+
+API_EXPORT
+int lte_crc_attach(int type, uint8_t *data, int len)
+{
+	int i, n;
+	uint32_t crc;
+
+	if ((type < 0) || (type >= NUM_CRC) || (len < 0))
+		return -EINVAL;
+
+	crc = lte_crc(type, data, len);
+	n = crc_params[type].width / 8;
+
+	for (i = 0; i < n; i++)
+		data[len + i] = crc >> (8 * (n - i - 1));
+
+	return len + n;
+}
+
+API_EXPORT
+int lte_crc_check(int type, const uint8_t *data, int len)
+{
+	if ((type < 0) || (type >= NUM_CRC) ||
+	    (len < crc_params[type].width / 8))
+		return -EINVAL;
+
+	return !lte_crc(type, data, len);
+}
+
+/* CRC remainder for decoder early termination */
+uint32_t turbo_crc24(int type, const uint8_t *in, int len)
+{
+	switch (type) {
+	case TDEC_CRC_24A:
+		return lte_crc(LTE_CRC24A, in, len);
+	case TDEC_CRC_24B:
+		return lte_crc(LTE_CRC24B, in, len);
+	}
+
+	return 0;
+}
@@ -0,0 +1,51 @@
+/*
+ * LTE cyclic redundancy check parameters
+ *
+ * Copyright (C) 2015 Ettus Research LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Tom Tsou <tom.tsou@ettus.com>
+ */
+
+#ifndef _TURBO_CRC_H_
+#define _TURBO_CRC_H_
+
+#include <stdint.h>
+#include "turbofec/crc.h"
+
+/*
+ * 3GPP TS 36.212 Release 8
+ * 5.1.1 "CRC calculation"
+ */
+#define CRC24A_POLY		0x864cfb
+#define CRC24B_POLY		0x800063
+#define CRC16_POLY		0x1021
+#define CRC8_POLY		0x9b
+
+#define NUM_CRC			4
+
+struct lte_crc_param {
+	int width;
+	uint32_t poly;
+};
+
+static const struct lte_crc_param crc_params[NUM_CRC] = {
+	[LTE_CRC24A] = { 24, CRC24A_POLY },
+	[LTE_CRC24B] = { 24, CRC24B_POLY },
+	[LTE_CRC16]  = { 16, CRC16_POLY },
+	[LTE_CRC8]   = {  8, CRC8_POLY },
+};
+
+#endif /* _TURBO_CRC_H_ */
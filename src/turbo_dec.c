@@ -26,87 +26,574 @@
 #include <string.h>
 #include <errno.h>
 #include <math.h>
+#include <time.h>
 #include "turbofec/turbo.h"
 #include "turbo_int.h"
 #include "turbo_sse.h"
+#include "turbo_int8_sse.h"
+#include "turbo_avx2.h"
 
 #define SSE_ALIGN		__attribute__((aligned(16)))
+#define AVX_ALIGN		__attribute__((aligned(32)))
 #define API_EXPORT		__attribute__((__visibility__("default")))
 
-#define NUM_TRELLIS_STATES	8
-#define MAX_TRELLIS_LEN		(TURBO_MAX_K + 3)
+/* Extrinsic scaling factors are given in steps of 1 / SCALE_ONE */
+#define SCALE_SHIFT		4
+#define SCALE_ONE		(1 << SCALE_SHIFT)
 
-/* Initialization value for forward and backward sums */
-#define SUM_INIT		16000
+/* Log-MAP correction table size and default input scale */
+#define JAC_LEN			16
+#define DEFAULT_LLR_UNIT	16
 
 struct tmetric {
 	int16_t bm[NUM_TRELLIS_STATES];
 	int16_t fwsums[NUM_TRELLIS_STATES];
 };
 
+/* Radix-4 metrics - branch metrics of two consecutive trellis stages */
+struct tmetric4 {
+	int16_t bm[2 * NUM_TRELLIS_STATES];
+	int16_t fwsums[NUM_TRELLIS_STATES];
+};
+
+/*
+ * 8-bit metrics - branch and forward metrics of one stage of two trellis
+ * segments in the lower and upper halves
+ */
+struct tmetric8 {
+	int8_t bm[2 * NUM_TRELLIS_STATES];
+	int8_t fwsums[2 * NUM_TRELLIS_STATES];
+};
+
 /*
  * Trellis Object
  *
- * sums       - Accumulated path metrics
- * outputs    - Trellis ouput values
- * metrics    - Path metrics
- * vals       - Input value that led to each state
+ * tm         - Radix-2 metrics of the current window
+ * tm4        - Radix-4 metrics of the current window (shares 'tm' storage)
+ * tail       - Radix-2 metrics for an odd trailing radix-4 trellis stage
+ * bwsums     - Backward metrics of the current step
+ * fwnorm     - Forward normalization values of the current window
+ * bnd        - Backward metrics at window boundaries from the last iteration
+ * scale      - Extrinsic output scaling factor in units of 1 / SCALE_ONE
+ * jac        - Log-MAP correction table
+ * jac_shift  - Metric difference shift of the correction table index
+ * lvals      - L-values
  */
 struct vtrellis {
 	struct tmetric *tm;
+	struct tmetric4 *tm4;
+	struct tmetric *tail;
 	int16_t *bwsums;
 	int16_t *fwnorm;
+	int16_t (*bnd)[NUM_TRELLIS_STATES];
+	int scale;
+	int8_t jac[JAC_LEN];
+	int jac_shift;
 	int16_t lvals[MAX_TRELLIS_LEN];
 };
 
+/*
+ * Interleaved L-value addressing
+ *
+ * The second constituent decoder reads its a-priori values from, and writes
+ * its extrinsic values to, the natural order L-values of the first decoder
+ * in place. Addresses are generated step by step from the QPP recurrence
+ * Pi(i + 1) = Pi(i) + g(i) and g(i + 1) = g(i) + 2 * f2, modulo K, which
+ * replaces separate interleaving passes and address table loads. Tail steps
+ * beyond K are not interleaved and use the decoder's own L-values.
+ *
+ * lv     - Natural order L-values
+ * ext    - Natural order extrinsic output, the same as 'lv' for in place
+ *          operation
+ * tail   - L-values of the second decoder, used from step K
+ * lv8    - Natural order 8-bit L-values used instead of 'lv' and 'ext' or
+ *          NULL
+ * shift  - Scale of 8-bit L-values as a power of two
+ * k      - Interleaver length
+ * f1, f2 - Interleaver coefficients
+ * f2x2   - Recurrence increment 2 * f2 modulo K
+ * i      - Current trellis step
+ * pi, g  - Current address and address increment
+ */
+struct tqpp {
+	int16_t *lv;
+	int16_t *ext;
+	int16_t *tail;
+	int8_t *lv8;
+	int shift;
+	int k;
+	int f1;
+	int f2;
+	int f2x2;
+	int i;
+	int pi;
+	int g;
+};
+
+/*
+ * Recursion kernel
+ *
+ * fw - Forward recursion over 'n' steps starting from forward metrics 'sums'.
+ *      Forward metrics of the last step are returned in 'sums'.
+ * bw - Backward recursion over 'n' steps starting from the current backward
+ *      metrics. A-priori values in 'lv' are replaced with extrinsic output.
+ * x  - Forward and backward recursions over 'n' steps run concurrently from
+ *      opposite ends, starting from forward metrics 'sums' and the current
+ *      backward metrics. Optional, replaces separate 'fw' and 'bw' passes.
+ *
+ * With 'q' set, L-values are accessed through the interleaved addressing
+ * instead of 'lv', starting from the first step for the forward recursion
+ * and from the last step for the backward recursion.
+ */
+struct tkernel {
+	void (*fw)(struct vtrellis *trellis, int16_t *sums, int n,
+		   const int8_t *x, const int8_t *z, const int16_t *lv,
+		   struct tqpp *q);
+	void (*bw)(struct vtrellis *trellis, int n,
+		   const int8_t *z, int16_t *lv, struct tqpp *q);
+	void (*x)(struct vtrellis *trellis, int16_t *sums, int n,
+		  const int8_t *x, const int8_t *z, int16_t *lv,
+		  struct tqpp *q);
+};
+
 /*
  * Turbo Decoder
  *
- * n         - Code order 
- * k         - Constraint length 
  * len       - Horizontal length of trellis
- * trellis   - Trellis object
- * punc      - Puncturing sequence
- * paths     - Trellis paths
+ * win       - Sliding window length or 0 for full length recursions
+ * train     - Backward training length at window boundaries
+ * crc       - Early termination CRC type
+ * agree     - Early termination on constituent decoder agreement
+ * min_lval  - Early termination L-value magnitude threshold
+ * llr_unit  - Input soft value scale of the log-MAP correction table
+ * kernel    - Recursion kernel
+ * int8      - 8-bit recursions selected instead of the recursion kernel
+ * int8_iter - Number of initial 8-bit iterations before the kernel runs
+ * trellis   - Trellis objects for the two constituent decoders
+ * tm        - Metric storage sized for a single window
+ * fwnorm    - Forward normalization storage sized for a single window
+ * plain     - Default option decoder of multi-block decoding, allocated on
+ *             first use
+ * par       - Parallel segment decoding state or NULL
+ * shuf      - Shuffled decoding state or NULL
+ * sync      - Pool to synchronize with between windows or NULL
+ * tm8       - 8-bit metric storage, allocated on first use
+ * nii8      - 8-bit segment boundary metrics [trellis][forward/backward]
+ * state     - TTI code block states, allocated on first use
+ * num_state - Number of allocated TTI code block states
+ * known     - Known bit signs of single code block decoding or NULL
+ * lvals8    - 8-bit exchanged L-values or NULL for 16-bit exchange
+ * lv8_shift - Scale of 8-bit L-values as a power of two
  */
 struct tdecoder {
 	int len;
+	int win;
+	int train;
+	int crc;
+	int agree;
+	int min_lval;
+	int llr_unit;
+	const struct tkernel *kernel;
+	int int8;
+	int int8_iter;
 	struct vtrellis trellis[2];
+	struct tdecoder2 *pair;
+	struct tbatch *batch;
+	struct tdecoder *plain;
+	struct tparallel *par;
+	struct tshuffle *shuf;
+	struct tpool *sync;
+	struct tmetric *tm;
+	int16_t *fwnorm;
+	struct tmetric8 *tm8;
+	int8_t nii8[2][2][NUM_TRELLIS_STATES];
+	struct tstate *state;
+	int num_state;
+	int8_t *known;
+	int8_t *lvals8;
+	int lv8_shift;
 
 	SSE_ALIGN int16_t bwsums[8];
-	SSE_ALIGN struct tmetric tm[MAX_TRELLIS_LEN + 1];
-	int16_t fwnorm[MAX_TRELLIS_LEN];
+	SSE_ALIGN struct tmetric tail[2];
+	SSE_ALIGN int8_t bwsums8[2 * NUM_TRELLIS_STATES];
+};
+
+/*
+ * Segment boundary metrics
+ *
+ * fw_in     - Forward metrics at the segment start or NULL for trellis start
+ * bw_in     - Backward metrics at the segment end or NULL for trellis end
+ * fw_out    - Forward metrics at the segment end
+ * bw_out    - Backward metrics at the segment start
+ */
+struct tseg {
+	const int16_t *fw_in;
+	const int16_t *bw_in;
+	int16_t *fw_out;
+	int16_t *bw_out;
+};
+
+/*
+ * Parallel Segment Decoder
+ *
+ * The trellis is split into 'num' segments of 'slen' steps, each decoded by
+ * a separate pool participant with its own metric storage. Participant 0 is
+ * the calling decoder. Boundary metrics are exchanged between neighbouring
+ * segments through two banks selected by iteration parity, so that metrics
+ * of the previous iteration are read while the current ones are written.
+ *
+ * pool      - Thread pool
+ * dec       - Participant decoders
+ * len       - Code block length
+ * iter      - Number of iterations
+ * slen      - Segment length
+ * num       - Number of segments
+ * used      - Number of iterations run before early termination or 0
+ * x, z      - Systematic and parity inputs of both constituent decoders
+ * fw, bw    - Boundary metrics [bank][trellis][segment]
+ * bits      - Hard decisions of the first constituent decoder
+ * stop      - Early termination result of each participant
+ * apri      - A-priori values of the last half-iteration or NULL
+ */
+struct tparallel {
+	struct tpool *pool;
+	struct tdecoder *dec[TDEC_MAX_PARALLEL];
+	int len;
+	int iter;
+	int slen;
+	int num;
+	int used;
+	const int8_t *x[2];
+	const int8_t *z[2];
+	int16_t fw[2][2][TDEC_MAX_PARALLEL][NUM_TRELLIS_STATES];
+	int16_t bw[2][2][TDEC_MAX_PARALLEL][NUM_TRELLIS_STATES];
+	uint8_t bits[TURBO_MAX_K / 8];
+	int stop[TDEC_MAX_PARALLEL];
+	int16_t *apri;
+};
+
+/*
+ * Shuffled Decoder
+ *
+ * Both constituent decoders run concurrently on a pool of two participants
+ * instead of one after the other. Each decoder reads its a-priori values
+ * from the extrinsic output of the other decoder while that output is being
+ * written, so values produced earlier in the same iteration are used as
+ * soon as they are available. Participant 0 is the calling decoder and runs
+ * the first constituent decoder.
+ *
+ * pool      - Thread pool
+ * dec       - Participant decoders
+ * len       - Code block length
+ * iter      - Number of iterations
+ * used      - Number of iterations run before early termination or 0
+ * stop      - Early termination result of the current iteration
+ * x, z      - Systematic and parity inputs of both constituent decoders
+ * ext       - Extrinsic output of the first constituent decoder
+ */
+struct tshuffle {
+	struct tpool *pool;
+	struct tdecoder *dec[2];
+	int len;
+	int iter;
+	int used;
+	int stop;
+	const int8_t *x[2];
+	const int8_t *z[2];
+	int16_t ext[MAX_TRELLIS_LEN];
+};
+
+#ifdef HAVE_AVX2
+struct tmetric2 {
+	int16_t bm[2 * NUM_TRELLIS_STATES];
+	int16_t fwsums[2 * NUM_TRELLIS_STATES];
+};
+
+/*
+ * Paired Trellis Object
+ *
+ * xz      - Systematic and parity input pairs (x0, x1, z0, z1)
+ * lvals   - L-value pairs (l0, l1)
+ */
+struct vtrellis2 {
+	int16_t xz[MAX_TRELLIS_LEN][4];
+	int16_t lvals[MAX_TRELLIS_LEN][2];
 };
 
+/*
+ * Paired Turbo Decoder
+ *
+ * Decoder state for two code blocks of equal length decoded in the low and
+ * high lanes of AVX2 registers. Allocated on first use and owned by the
+ * parent decoder object.
+ */
+struct tdecoder2 {
+	struct vtrellis2 trellis[2];
+
+	AVX_ALIGN int16_t bwsums[2 * NUM_TRELLIS_STATES];
+	AVX_ALIGN struct tmetric2 tm[MAX_TRELLIS_LEN + 1];
+	int16_t fwnorm[MAX_TRELLIS_LEN][2];
+};
+#endif
+
+static const struct tkernel kernel_r2;
+static const struct tkernel kernel_r4;
+static const struct tkernel kernel_lm;
+static const struct tkernel kernel_x;
+static const struct tkernel kernel_m;
+
 /* Allocate and initialize the trellis object */
 static int generate_trellis(struct vtrellis *trellis,
-			    struct tmetric *tm,
-			    int16_t *bwsums, int16_t *fwnorm)
+			    struct tmetric *tm, struct tmetric *tail,
+			    int16_t *bwsums, int16_t *fwnorm,
+			    int16_t (*bnd)[NUM_TRELLIS_STATES])
 {
 	trellis->tm = tm;
+	trellis->tm4 = (struct tmetric4 *) tm;
+	trellis->tail = tail;
 	trellis->bwsums = bwsums;
 	trellis->fwnorm = fwnorm;
+	trellis->bnd = bnd;
+
+	return 0;
+}
+
+/*
+ * Allocate metric storage
+ *
+ * With sliding windows, metrics are only held for a single window of 'win'
+ * trellis steps. Radix-4 metrics for a window fit into the same storage.
+ * Window boundary metrics are kept for both constituent decoders.
+ */
+static int alloc_metrics(struct tdecoder *dec, int win)
+{
+	int len = win ? win : MAX_TRELLIS_LEN;
+	int num = win ? (MAX_TRELLIS_LEN + win - 1) / win : 0;
+	struct tmetric *tm;
+	int16_t *fwnorm, (*bnd)[NUM_TRELLIS_STATES] = NULL;
+
+#if defined(__MACH__)
+	if (posix_memalign((void **) &tm, 16,
+			   (len + 1) * sizeof(struct tmetric)))
+		return -ENOMEM;
+#else
+	tm = (struct tmetric *) memalign(16, (len + 1) * sizeof(struct tmetric));
+	if (!tm)
+		return -ENOMEM;
+#endif
+	fwnorm = (int16_t *) malloc(len * sizeof(int16_t));
+	if (num)
+		bnd = malloc(2 * num * sizeof(*bnd));
+
+	if (!fwnorm || (num && !bnd)) {
+		free(tm);
+		free(fwnorm);
+		free(bnd);
+		return -ENOMEM;
+	}
+
+	free(dec->tm);
+	free(dec->fwnorm);
+	free(dec->trellis[0].bnd);
+
+	dec->tm = tm;
+	dec->fwnorm = fwnorm;
+	dec->win = win;
+
+	generate_trellis(&dec->trellis[0], tm, dec->tail,
+			 dec->bwsums, fwnorm, bnd);
+	generate_trellis(&dec->trellis[1], tm, dec->tail,
+			 dec->bwsums, fwnorm, num ? &bnd[num] : NULL);
 
 	return 0;
 }
 
 /*
  * Reset decoder
+ *
+ * Backward sums are cleared so that decoded output does not depend on
+ * previously decoded code blocks.
  */
 static void init_tdec(struct tdecoder *dec, int len)
 {
+	int num;
+
 	memset(dec->trellis[0].lvals, 0, len * sizeof(int16_t));
 	memset(dec->trellis[1].lvals, 0, len * sizeof(int16_t));
+	memset(dec->bwsums, 0, 8 * sizeof(int16_t));
+	memset(dec->nii8, 0, sizeof(dec->nii8));
+
+	if (dec->lvals8)
+		memset(dec->lvals8, 0, len * sizeof(int8_t));
+
+	if (dec->win) {
+		num = (len + dec->win - 1) / dec->win;
+		memset(dec->trellis[0].bnd, 0, num * sizeof(*dec->trellis[0].bnd));
+		memset(dec->trellis[1].bnd, 0, num * sizeof(*dec->trellis[1].bnd));
+	}
 
 	dec->len = len;
 }
 
+/* Release parallel segment decoder and participant decoders */
+static void free_tpar(struct tparallel *par)
+{
+	int i;
+
+	if (!par)
+		return;
+
+	free_tpool(par->pool);
+	for (i = 1; i < TDEC_MAX_PARALLEL; i++)
+		free_tdec(par->dec[i]);
+	free(par);
+}
+
+/*
+ * Log-MAP correction table
+ *
+ * Metrics are scaled by 2 * 'unit' steps per nat, so the correction term of
+ * a metric difference d is c(d) = 2 * unit * log(1 + exp(-d / (2 * unit))).
+ * Entry JAC_LEN - 1 - i holds c(d) at the centre of index interval i. The
+ * index spacing is the smallest power of two at which the table covers all
+ * differences with a correction of at least one step. Entry 0 applies to
+ * all larger differences and is zero.
+ */
+static void set_llr_unit(struct tdecoder *dec, int unit)
+{
+	int i, shift = 0;
+	int8_t jac[JAC_LEN];
+	double m = 2 * unit, dmax = m * log(m);
+
+	while (((JAC_LEN - 1) << shift) < dmax)
+		shift++;
+
+	jac[0] = 0;
+	for (i = 0; i < JAC_LEN - 1; i++) {
+		jac[JAC_LEN - 1 - i] =
+			lround(m * log1p(exp(-(i + 0.5) * (1 << shift) / m)));
+	}
+
+	for (i = 0; i < 2; i++) {
+		memcpy(dec->trellis[i].jac, jac, sizeof(jac));
+		dec->trellis[i].jac_shift = shift;
+	}
+
+	dec->llr_unit = unit;
+}
+
+/* Copy recursion options to a participant decoder */
+static int inherit_opts(struct tdecoder *sub, const struct tdecoder *dec)
+{
+	sub->kernel = dec->kernel;
+	sub->int8 = dec->int8;
+	sub->train = dec->train;
+	sub->crc = dec->crc;
+	sub->agree = dec->agree;
+	sub->min_lval = dec->min_lval;
+	sub->trellis[0].scale = dec->trellis[0].scale;
+	sub->trellis[1].scale = dec->trellis[1].scale;
+	set_llr_unit(sub, dec->llr_unit);
+
+	if (dec->win)
+		return alloc_metrics(sub, dec->win);
+
+	return 0;
+}
+
+/*
+ * Allocate parallel segment decoder with 'num' participants
+ *
+ * Participant decoders inherit the recursion options of the calling decoder.
+ */
+static struct tparallel *alloc_tpar(struct tdecoder *dec, int num)
+{
+	int i;
+	struct tparallel *par;
+
+	par = (struct tparallel *) calloc(1, sizeof(struct tparallel));
+	if (!par)
+		return NULL;
+
+	par->pool = alloc_tpool(num);
+	if (!par->pool)
+		goto fail;
+
+	par->dec[0] = dec;
+
+	for (i = 1; i < num; i++) {
+		par->dec[i] = alloc_tdec();
+		if (!par->dec[i])
+			goto fail;
+
+		if (inherit_opts(par->dec[i], dec) < 0)
+			goto fail;
+	}
+
+	return par;
+fail:
+	free_tpar(par);
+	return NULL;
+}
+
+/* Release shuffled decoder and participant decoder */
+static void free_tshuf(struct tshuffle *shuf)
+{
+	if (!shuf)
+		return;
+
+	free_tpool(shuf->pool);
+	free_tdec(shuf->dec[1]);
+	free(shuf);
+}
+
+/*
+ * Allocate shuffled decoder
+ *
+ * The participant decoder inherits the recursion options of the calling
+ * decoder.
+ */
+static struct tshuffle *alloc_tshuf(struct tdecoder *dec)
+{
+	struct tshuffle *shuf;
+
+	shuf = (struct tshuffle *) calloc(1, sizeof(struct tshuffle));
+	if (!shuf)
+		return NULL;
+
+	shuf->pool = alloc_tpool(2);
+	if (!shuf->pool)
+		goto fail;
+
+	shuf->dec[0] = dec;
+	shuf->dec[1] = alloc_tdec();
+	if (!shuf->dec[1] || (inherit_opts(shuf->dec[1], dec) < 0))
+		goto fail;
+
+	return shuf;
+fail:
+	free_tshuf(shuf);
+	return NULL;
+}
+
 /* Release decoder object */
 API_EXPORT void free_tdec(struct tdecoder *dec)
 {
 	if (!dec)
 		return;
 
+	free(dec->pair);
+	free_tbatch(dec->batch);
+	free_tdec(dec->plain);
+	free_tpar(dec->par);
+	free_tshuf(dec->shuf);
+	free(dec->state);
+	free(dec->known);
+	free(dec->lvals8);
+	free(dec->tm8);
+	free(dec->tm);
+	free(dec->fwnorm);
+	free(dec->trellis[0].bnd);
 	free(dec);
 }
 
@@ -123,141 +610,2328 @@ API_EXPORT struct tdecoder *alloc_tdec()
 {
 	struct tdecoder *dec;
 
-	dec = (struct tdecoder *) malloc(sizeof(struct tdecoder));
-	dec->len = 0;
-
-	generate_trellis(&dec->trellis[0], dec->tm,
-			 dec->bwsums, dec->fwnorm);
-
-	generate_trellis(&dec->trellis[1], dec->tm,
-			 dec->bwsums, dec->fwnorm);
+	dec = (struct tdecoder *) calloc(1, sizeof(struct tdecoder));
+	if (!dec)
+		return NULL;
 
-	memset(dec->tm[0].fwsums, 0, 8 * sizeof(int16_t));
-	memset(dec->bwsums, 0, 8 * sizeof(int16_t));
+	dec->kernel = &kernel_r2;
+	dec->trellis[0].scale = SCALE_ONE;
+	dec->trellis[1].scale = SCALE_ONE;
+	set_llr_unit(dec, DEFAULT_LLR_UNIT);
 
-	dec->tm[0].fwsums[0] = SUM_INIT;
+	if (alloc_metrics(dec, 0) < 0) {
+		free(dec);
+		return NULL;
+	}
 
 	return dec;
 }
 
-static int turbo_iterate(struct vtrellis *trellis, int len,
-			 const int8_t *x, const int8_t *z)
+/*
+ * Set decoder option
+ *
+ * Options apply to subsequent calls on the decoder object. Multiple code
+ * block decoding always uses full length radix-2 recursions. Recursion
+ * options are forwarded to parallel segment and shuffled decoders, which
+ * do not use 8-bit L-value exchange.
+ */
+API_EXPORT int tdec_set_opt(struct tdecoder *dec, int opt, int val)
 {
-	int i;
-	struct tmetric *tm = trellis->tm;
+	int i, rc, sub = (opt != TDEC_OPT_PARALLEL) &&
+			 (opt != TDEC_OPT_SHUFFLE) &&
+			 (opt != TDEC_OPT_LVAL8);
 
-	/* We have enough headroom to not clear all sums */
-	trellis->bwsums[0] = SUM_INIT;
+	/* Shuffled decoding exchanges L-values at window boundaries */
+	if (((opt == TDEC_OPT_SHUFFLE) && (val == 1) && !dec->win) ||
+	    ((opt == TDEC_OPT_WINDOW) && !val && dec->shuf))
+		return -EINVAL;
 
-	/* Forward */
-	for (i = 0; i < len; i++) {
-		trellis->fwnorm[i] = gen_fw_metrics(tm[i].bm,
-						    x[i], z[i],
-						    tm[i].fwsums,
-						    tm[i + 1].fwsums,
-						    trellis->lvals[i]);
+	if (dec->par && sub) {
+		for (i = 1; i < tpool_size(dec->par->pool); i++) {
+			rc = tdec_set_opt(dec->par->dec[i], opt, val);
+			if (rc < 0)
+				return rc;
+		}
 	}
 
-	/* Backward */
-	for (i = len - 1; i >= 0; i--) {
-		trellis->lvals[i] = gen_bw_metrics(tm[i].bm,
-						   z[i],
-						   tm[i].fwsums,
-						   trellis->bwsums,
-						   trellis->fwnorm[i]);
+	if (dec->shuf && sub) {
+		rc = tdec_set_opt(dec->shuf->dec[1], opt, val);
+		if (rc < 0)
+			return rc;
+	}
+
+	switch (opt) {
+	case TDEC_OPT_KERNEL:
+		switch (val) {
+		case TDEC_KERNEL_RADIX2:
+			dec->kernel = &kernel_r2;
+			dec->int8 = 0;
+			break;
+		case TDEC_KERNEL_RADIX4:
+			dec->kernel = &kernel_r4;
+			dec->int8 = 0;
+			break;
+		case TDEC_KERNEL_INT8:
+			dec->int8 = 1;
+			break;
+		case TDEC_KERNEL_LOGMAP:
+			dec->kernel = &kernel_lm;
+			dec->int8 = 0;
+			break;
+		case TDEC_KERNEL_XSCHED:
+			dec->kernel = &kernel_x;
+			dec->int8 = 0;
+			break;
+		case TDEC_KERNEL_MODULO:
+			dec->kernel = &kernel_m;
+			dec->int8 = 0;
+			break;
+		default:
+			return -EINVAL;
+		}
+		break;
+	case TDEC_OPT_WINDOW:
+		if (val && ((val < TDEC_MIN_WINDOW) || (val > TURBO_MAX_K) ||
+			    (val % 8)))
+			return -EINVAL;
+		if (val != dec->win)
+			return alloc_metrics(dec, val);
+		break;
+	case TDEC_OPT_TRAIN:
+		if ((val < 0) || (val > TURBO_MAX_K))
+			return -EINVAL;
+		dec->train = val;
+		break;
+	case TDEC_OPT_CRC:
+		if ((val < TDEC_CRC_NONE) || (val > TDEC_CRC_24B))
+			return -EINVAL;
+		dec->crc = val;
+		break;
+	case TDEC_OPT_AGREE:
+		if ((val < 0) || (val > 1))
+			return -EINVAL;
+		dec->agree = val;
+		break;
+	case TDEC_OPT_MIN_LVAL:
+		if ((val < 0) || (val > INT16_MAX))
+			return -EINVAL;
+		dec->min_lval = val;
+		break;
+	case TDEC_OPT_SCALE:
+		if ((val < 1) || (val > SCALE_ONE))
+			return -EINVAL;
+		dec->trellis[0].scale = val;
+		dec->trellis[1].scale = val;
+		break;
+	case TDEC_OPT_LLR_UNIT:
+		if ((val < 1) || (val > TDEC_MAX_LLR_UNIT))
+			return -EINVAL;
+		set_llr_unit(dec, val);
+		break;
+	case TDEC_OPT_INT8_ITER:
+		if (val < 0)
+			return -EINVAL;
+		dec->int8_iter = val;
+		break;
+	case TDEC_OPT_LVAL8:
+		if ((val < 0) || (val > TDEC_MAX_LVAL8) || (val & (val - 1)))
+			return -EINVAL;
+
+		free(dec->lvals8);
+		dec->lvals8 = NULL;
+
+		if (val) {
+			dec->lvals8 = (int8_t *) calloc(MAX_TRELLIS_LEN,
+							sizeof(int8_t));
+			if (!dec->lvals8)
+				return -ENOMEM;
+			dec->lv8_shift = __builtin_ctz(val);
+		}
+		break;
+	case TDEC_OPT_PARALLEL:
+		if ((val < 1) || (val > TDEC_MAX_PARALLEL))
+			return -EINVAL;
+		if (val == (dec->par ? tpool_size(dec->par->pool) : 1))
+			break;
+
+		free_tpar(dec->par);
+		dec->par = NULL;
+
+		if (val > 1) {
+			dec->par = alloc_tpar(dec, val);
+			if (!dec->par)
+				return -ENOMEM;
+		}
+		break;
+	case TDEC_OPT_SHUFFLE:
+		if ((val < 0) || (val > 1))
+			return -EINVAL;
+		if (val == (dec->shuf != NULL))
+			break;
+
+		free_tshuf(dec->shuf);
+		dec->shuf = NULL;
+
+		if (val) {
+			dec->shuf = alloc_tshuf(dec);
+			if (!dec->shuf)
+				return -ENOMEM;
+		}
+		break;
+	default:
+		return -EINVAL;
 	}
 
 	return 0;
 }
 
-static inline void _turbo_decode(struct tdecoder *dec,
-				 int len, int iter, uint8_t *output,
-				 const int8_t *d0, const int8_t *d1,
-				 const int8_t *d2)
+/*
+ * Set known bits
+ *
+ * Known bits are held as signs of the soft value convention, where zero
+ * marks an unknown bit. Storage is released when all bits are cleared, so
+ * decoding without known bits is unaffected.
+ */
+API_EXPORT int tdec_set_known(struct tdecoder *dec, int start, int n,
+			      const uint8_t *bits)
 {
 	int i;
-	int8_t d0p[len + 3];
-	struct vtrellis *trellis = dec->trellis;
 
-	turbo_interleave(len, (uint8_t *) d0, (uint8_t *) d0p);
-	turbo_unterm(len, (uint8_t *) d0, (uint8_t *) d1,
-		     (uint8_t *) d2, (uint8_t *) d0p);
+	if (!n) {
+		free(dec->known);
+		dec->known = NULL;
+		return 0;
+	}
 
-	init_tdec(dec, len + 3);
+	if ((start < 0) || (n < 0) || (start + n > TURBO_MAX_K))
+		return -EINVAL;
 
-	for (i = 0; i < iter; i++) {
-		turbo_iterate(&trellis[0], dec->len, d0, d1);
-		turbo_interleave_lval(len,
-				      trellis[0].lvals,
-				      trellis[1].lvals);
-
-		turbo_iterate(&trellis[1], dec->len, d0p, d2);
-		turbo_deinterleave_lval(len,
-					trellis[1].lvals,
-					trellis[0].lvals);
+	if (!dec->known) {
+		dec->known = (int8_t *) calloc(TURBO_MAX_K, sizeof(int8_t));
+		if (!dec->known)
+			return -ENOMEM;
 	}
+
+	for (i = 0; i < n; i++)
+		dec->known[start + i] = bits && bits[i] ? 1 : -1;
+
+	return 0;
 }
 
-#define SLICE_PACK_LE(X,I) \
-	((X[I + 0] > 0 ? 1 : 0) << 0) | \
-	((X[I + 1] > 0 ? 1 : 0) << 1) | \
-	((X[I + 2] > 0 ? 1 : 0) << 2) | \
-	((X[I + 3] > 0 ? 1 : 0) << 3) | \
-	((X[I + 4] > 0 ? 1 : 0) << 4) | \
-	((X[I + 5] > 0 ? 1 : 0) << 5) | \
-	((X[I + 6] > 0 ? 1 : 0) << 6) | \
-	((X[I + 7] > 0 ? 1 : 0) << 7)
+/* Set up interleaved addressing of block size 'k' at trellis step 0 */
+static int qpp_init(struct tqpp *q, int k, int16_t *lv, int16_t *tail)
+{
+	if (turbo_interleave_qpp(k, &q->f1, &q->f2) < 0)
+		return -EINVAL;
+
+	q->lv = lv;
+	q->ext = lv;
+	q->tail = tail;
+	q->lv8 = NULL;
+	q->k = k;
+	q->f1 %= k;
+	q->f2 %= k;
+	q->f2x2 = 2 * q->f2 % k;
+	q->i = 0;
+	q->pi = 0;
+	q->g = (q->f1 + q->f2) % k;
+
+	return 0;
+}
 
-#define SLICE_PACK_BE(X,I) \
-	((X[I + 0] > 0 ? 1 : 0) << 7) | \
-	((X[I + 1] > 0 ? 1 : 0) << 6) | \
-	((X[I + 2] > 0 ? 1 : 0) << 5) | \
-	((X[I + 3] > 0 ? 1 : 0) << 4) | \
-	((X[I + 4] > 0 ? 1 : 0) << 3) | \
-	((X[I + 5] > 0 ? 1 : 0) << 2) | \
-	((X[I + 6] > 0 ? 1 : 0) << 1) | \
-	((X[I + 7] > 0 ? 1 : 0) << 0)
 /*
- * Default to big endian byte packing
+ * Set up natural order addressing of block size 'k' at trellis step 0
+ *
+ * The QPP with f1 = 1 and f2 = 0 is the identity, which allows separate
+ * a-priori and extrinsic buffers for the first constituent decoder. Tail
+ * steps use 'tail' as with interleaved addressing.
  */
-#ifdef PACK_LE
-#define SLICE_PACK	SLICE_PACK_LE
-#else
-#define SLICE_PACK	SLICE_PACK_BE
-#endif
+static void qpp_init_natural(struct tqpp *q, int k, int16_t *lv,
+			     int16_t *tail)
+{
+	q->lv = lv;
+	q->ext = lv;
+	q->tail = tail;
+	q->lv8 = NULL;
+	q->k = k;
+	q->f1 = 1;
+	q->f2 = 0;
+	q->f2x2 = 0;
+	q->i = 0;
+	q->pi = 0;
+	q->g = 1 % k;
+}
 
-API_EXPORT
-int lte_turbo_decode(struct tdecoder *dec,
-		     int len, int iter, uint8_t *output,
-		     const int8_t *d0, const int8_t *d1, const int8_t *d2)
+/* Move interleaved addressing to trellis step 'i' */
+static inline void qpp_seek(struct tqpp *q, int i)
 {
-	int i;
+	q->i = i;
 
-	if ((len < TURBO_MIN_K) || len > TURBO_MAX_K)
-		return -EINVAL;
+	if (i < q->k) {
+		q->pi = i * ((q->f1 + q->f2 * i) % q->k) % q->k;
+		q->g = (q->f1 + q->f2 * (2 * i + 1) % q->k) % q->k;
+	}
+}
 
-	_turbo_decode(dec, len, iter, output, d0, d1, d2);
+static inline int16_t *qpp_addr(const struct tqpp *q)
+{
+	return q->i < q->k ? &q->lv[q->pi] : &q->tail[q->i];
+}
 
-	for (i = 0; i < len / 8; i++)
-		output[i] = SLICE_PACK(dec->trellis[0].lvals, 8 * i);
+static inline int16_t *qpp_ext(const struct tqpp *q)
+{
+	return q->i < q->k ? &q->ext[q->pi] : &q->tail[q->i];
+}
 
-	return 0;
+/*
+ * Load and store at the current step
+ *
+ * With shuffled decoding, values are written by the other constituent
+ * decoder at the same time. Relaxed atomic accesses keep the individual
+ * values intact and compile to plain moves. 8-bit values are stored
+ * rounded and saturated.
+ */
+static inline int8_t pack_lval8(int16_t val, int shift)
+{
+	int v = (val + ((1 << shift) >> 1)) >> shift;
+
+	v = v > INT8_MAX ? INT8_MAX : v;
+	v = v < -INT8_MAX ? -INT8_MAX : v;
+
+	return v;
 }
 
-API_EXPORT
-int lte_turbo_decode_unpack(struct tdecoder *dec,
-			   int len, int iter, uint8_t *output,
-			   const int8_t *d0, const int8_t *d1, const int8_t *d2)
+static inline int16_t qpp_load(const struct tqpp *q)
 {
-	int i;
+	if (q->lv8 && (q->i < q->k)) {
+		return __atomic_load_n(&q->lv8[q->pi],
+				       __ATOMIC_RELAXED) << q->shift;
+	}
 
-	if ((len < TURBO_MIN_K) || len > TURBO_MAX_K)
-		return -EINVAL;
+	return __atomic_load_n(qpp_addr(q), __ATOMIC_RELAXED);
+}
 
-	_turbo_decode(dec, len, iter, output, d0, d1, d2);
+static inline void qpp_store(const struct tqpp *q, int16_t val)
+{
+	if (q->lv8 && (q->i < q->k)) {
+		__atomic_store_n(&q->lv8[q->pi], pack_lval8(val, q->shift),
+				 __ATOMIC_RELAXED);
+		return;
+	}
 
-	for (i = 0; i < len; i++)
-		output[i] = dec->trellis[0].lvals[i] > 0 ? 1 : 0;
+	__atomic_store_n(qpp_ext(q), val, __ATOMIC_RELAXED);
+}
+
+static inline void qpp_next(struct tqpp *q)
+{
+	if (q->i < q->k) {
+		q->pi += q->g;
+		if (q->pi >= q->k)
+			q->pi -= q->k;
+		q->g += q->f2x2;
+		if (q->g >= q->k)
+			q->g -= q->k;
+	}
+
+	q->i++;
+}
+
+static inline void qpp_prev(struct tqpp *q)
+{
+	q->i--;
+
+	if (q->i == q->k - 1) {
+		qpp_seek(q, q->i);
+	} else if (q->i < q->k - 1) {
+		q->g -= q->f2x2;
+		if (q->g < 0)
+			q->g += q->k;
+		q->pi -= q->g;
+		if (q->pi < 0)
+			q->pi += q->k;
+	}
+}
+
+/*
+ * Extrinsic scaling
+ *
+ * Max-log-MAP overestimates the reliability of its extrinsic output, which
+ * is scaled down before it is passed on as a-priori input. The scaling is
+ * rounded to nearest and leaves values unchanged at SCALE_ONE.
+ */
+static inline int16_t scale_lval(int16_t val, int scale)
+{
+	return (val * scale + (SCALE_ONE / 2)) >> SCALE_SHIFT;
+}
+
+/* A-priori value of step 'i' in forward order */
+static inline int16_t load_lval(const int16_t *lv, int i, struct tqpp *q)
+{
+	int16_t val;
+
+	if (!q)
+		return lv[i];
+
+	val = qpp_load(q);
+	qpp_next(q);
+
+	return val;
+}
+
+/* Extrinsic value of step 'i' in backward order */
+static inline void store_lval(int16_t *lv, int i, int16_t val,
+			      struct tqpp *q)
+{
+	if (!q) {
+		lv[i] = val;
+		return;
+	}
+
+	qpp_store(q, val);
+	qpp_prev(q);
+}
+
+/* A-priori value of step 'i' in backward order */
+static inline int16_t load_lval_bw(const int16_t *lv, int i, struct tqpp *q)
+{
+	int16_t val;
+
+	if (!q)
+		return lv[i];
+
+	val = qpp_load(q);
+	qpp_prev(q);
+
+	return val;
+}
+
+/* A-priori value of step 'i' replaced with extrinsic value in forward order */
+static inline int16_t swap_lval(int16_t *lv, int i, int16_t val,
+				struct tqpp *q)
+{
+	int16_t le;
+
+	if (!q) {
+		le = lv[i];
+		lv[i] = val;
+		return le;
+	}
+
+	le = qpp_load(q);
+	qpp_store(q, val);
+	qpp_next(q);
+
+	return le;
+}
+
+static inline void _fw_r2(struct vtrellis *trellis, int16_t *sums, int n,
+			  const int8_t *x, const int8_t *z, const int16_t *lv,
+			  struct tqpp *q)
+{
+	int i;
+	struct tmetric *tm = trellis->tm;
+
+	memcpy(tm[0].fwsums, sums, sizeof(tm[0].fwsums));
+
+	for (i = 0; i < n; i++) {
+		trellis->fwnorm[i] = gen_fw_metrics(tm[i].bm,
+						    x[i], z[i],
+						    tm[i].fwsums,
+						    tm[i + 1].fwsums,
+						    load_lval(lv, i, q));
+	}
+
+	memcpy(sums, tm[n].fwsums, sizeof(tm[n].fwsums));
+}
+
+static inline void _bw_r2(struct vtrellis *trellis, int n,
+			  const int8_t *z, int16_t *lv, struct tqpp *q)
+{
+	int i;
+	int16_t val;
+	struct tmetric *tm = trellis->tm;
+
+	for (i = n - 1; i >= 0; i--) {
+		val = gen_bw_metrics(tm[i].bm, z[i], tm[i].fwsums,
+				     trellis->bwsums, trellis->fwnorm[i]);
+		store_lval(lv, i, scale_lval(val, trellis->scale), q);
+	}
+}
+
+/*
+ * X-schedule recursions
+ *
+ * Forward and backward recursions start from opposite ends of the window at
+ * the same time and meet at the midpoint. In the first half, the forward
+ * recursion stores forward metrics as usual while the backward recursion
+ * generates its own branch metrics and stores backward metrics in the
+ * forward metric slots of the second half. In the second half, both
+ * recursions produce L-values against the metrics stored by the other. The
+ * two dependency chains are independent and interleave step by step.
+ *
+ * Backward metrics of step i + 1 are held in tm[i + 1].fwsums, which the
+ * forward recursion overwrites only after the L-value of step i. Backward
+ * metrics of the first half are normalized to state 0 instead of to the
+ * forward metrics, which offsets all states equally and leaves L-values
+ * unchanged.
+ */
+static inline void _x_r2(struct vtrellis *trellis, int16_t *sums, int n,
+			 const int8_t *x, const int8_t *z, int16_t *lv,
+			 struct tqpp *qf, struct tqpp *qb)
+{
+	int i, j, k, h = n / 2;
+	int16_t val;
+	struct tmetric *tm = trellis->tm;
+
+	memcpy(tm[0].fwsums, sums, sizeof(tm[0].fwsums));
+
+	for (k = 0; k < n - h; k++) {
+		i = k;
+		j = n - 1 - k;
+
+		if (i < h) {
+			trellis->fwnorm[i] = gen_fw_metrics(tm[i].bm,
+							    x[i], z[i],
+							    tm[i].fwsums,
+							    tm[i + 1].fwsums,
+							    load_lval(lv, i, qf));
+		}
+
+		memcpy(tm[j + 1].fwsums, trellis->bwsums,
+		       sizeof(tm[j + 1].fwsums));
+		gen_bw_train(x[j], z[j], load_lval_bw(lv, j, qb),
+			     trellis->bwsums);
+	}
+
+	for (k = 0; k < n - h; k++) {
+		i = h + k;
+		j = h - 1 - k;
+
+		val = gen_lval(tm[i].fwsums, tm[i + 1].fwsums, z[i]);
+		val = swap_lval(lv, i, scale_lval(val, trellis->scale), qf);
+		gen_fw_metrics(tm[i].bm, x[i], z[i], tm[i].fwsums,
+			       tm[i + 1].fwsums, val);
+
+		if (j >= 0) {
+			val = gen_bw_metrics(tm[j].bm, z[j], tm[j].fwsums,
+					     trellis->bwsums,
+					     trellis->fwnorm[j]);
+			store_lval(lv, j, scale_lval(val, trellis->scale), qb);
+		}
+	}
+
+	memcpy(sums, tm[n].fwsums, sizeof(tm[n].fwsums));
+}
+
+/*
+ * Radix-4 recursions
+ *
+ * Trellis stages are processed in pairs, which halves the number of
+ * sequentially dependent add-compare-select operations in both directions.
+ * With an odd number of stages, the last stage is handled by the radix-2
+ * recursions. Normalization values are stored once per stage pair.
+ */
+static inline void _fw_r4(struct vtrellis *trellis, int16_t *sums, int n,
+			  const int8_t *x, const int8_t *z, const int16_t *lv,
+			  struct tqpp *q)
+{
+	int i, m = n / 2;
+	int16_t le[2];
+	struct tmetric4 *tm4 = trellis->tm4;
+	struct tmetric *tail = trellis->tail;
+
+	memcpy(tm4[0].fwsums, sums, sizeof(tm4[0].fwsums));
+
+	for (i = 0; i < m; i++) {
+		le[0] = load_lval(lv, 2 * i + 0, q);
+		le[1] = load_lval(lv, 2 * i + 1, q);
+
+		trellis->fwnorm[i] = gen_fw_metrics_r4(tm4[i].bm,
+						       &x[2 * i], &z[2 * i],
+						       le,
+						       tm4[i].fwsums,
+						       tm4[i + 1].fwsums);
+	}
+
+	if (n % 2) {
+		trellis->fwnorm[m] = gen_fw_metrics(tail[0].bm,
+						    x[n - 1], z[n - 1],
+						    tm4[m].fwsums,
+						    tail[1].fwsums,
+						    load_lval(lv, n - 1, q));
+		memcpy(sums, tail[1].fwsums, sizeof(tail[1].fwsums));
+	} else {
+		memcpy(sums, tm4[m].fwsums, sizeof(tm4[m].fwsums));
+	}
+}
+
+static inline void _bw_r4(struct vtrellis *trellis, int n,
+			  const int8_t *z, int16_t *lv, struct tqpp *q)
+{
+	int i, m = n / 2;
+	int16_t le[2];
+	struct tmetric4 *tm4 = trellis->tm4;
+	struct tmetric *tail = trellis->tail;
+
+	if (n % 2) {
+		le[0] = gen_bw_metrics(tail[0].bm, z[n - 1], tm4[m].fwsums,
+				       trellis->bwsums, trellis->fwnorm[m]);
+		store_lval(lv, n - 1, scale_lval(le[0], trellis->scale), q);
+	}
+
+	for (i = m - 1; i >= 0; i--) {
+		gen_bw_metrics_r4(tm4[i].bm, &z[2 * i],
+				  tm4[i].fwsums, trellis->bwsums,
+				  trellis->fwnorm[i], le);
+
+		store_lval(lv, 2 * i + 1, scale_lval(le[1], trellis->scale), q);
+		store_lval(lv, 2 * i + 0, scale_lval(le[0], trellis->scale), q);
+	}
+}
+
+/*
+ * Log-MAP recursions
+ *
+ * Radix-2 recursions with the max* operation, using the correction table of
+ * the trellis.
+ */
+static inline void _fw_lm(struct vtrellis *trellis, int16_t *sums, int n,
+			  const int8_t *x, const int8_t *z, const int16_t *lv,
+			  struct tqpp *q)
+{
+	int i;
+	struct tmetric *tm = trellis->tm;
+
+	memcpy(tm[0].fwsums, sums, sizeof(tm[0].fwsums));
+
+	for (i = 0; i < n; i++) {
+		trellis->fwnorm[i] = gen_fw_metrics_lm(tm[i].bm,
+						       x[i], z[i],
+						       tm[i].fwsums,
+						       tm[i + 1].fwsums,
+						       load_lval(lv, i, q),
+						       trellis->jac,
+						       trellis->jac_shift);
+	}
+
+	memcpy(sums, tm[n].fwsums, sizeof(tm[n].fwsums));
+}
+
+static inline void _bw_lm(struct vtrellis *trellis, int n,
+			  const int8_t *z, int16_t *lv, struct tqpp *q)
+{
+	int i;
+	int16_t val;
+	struct tmetric *tm = trellis->tm;
+
+	for (i = n - 1; i >= 0; i--) {
+		val = gen_bw_metrics_lm(tm[i].bm, z[i], tm[i].fwsums,
+					trellis->bwsums, trellis->fwnorm[i],
+					trellis->jac, trellis->jac_shift);
+		store_lval(lv, i, scale_lval(val, trellis->scale), q);
+	}
+}
+
+/*
+ * Modulo normalized recursions
+ *
+ * Radix-2 recursions with wrapping metrics, which drops the per-step
+ * normalization from both dependency chains along with the stored
+ * normalization values. Incoming metrics are floored and outgoing metrics
+ * are normalized to state 0, so metrics outside of the recursions keep the
+ * usual form. A-priori values are clipped to bound the metric spread, which
+ * changes soft output relative to the radix-2 recursions.
+ */
+static inline int16_t clip_lval_mod(int16_t val)
+{
+	return val > MOD_MAX_LE ? MOD_MAX_LE :
+	       val < -MOD_MAX_LE ? -MOD_MAX_LE : val;
+}
+
+static inline void _fw_m(struct vtrellis *trellis, int16_t *sums, int n,
+			 const int8_t *x, const int8_t *z, const int16_t *lv,
+			 struct tqpp *q)
+{
+	int i;
+	struct tmetric *tm = trellis->tm;
+
+	memcpy(tm[0].fwsums, sums, sizeof(tm[0].fwsums));
+	gen_mod_init(tm[0].fwsums);
+
+	for (i = 0; i < n; i++) {
+		gen_fw_metrics_mod(tm[i].bm, x[i], z[i],
+				   tm[i].fwsums, tm[i + 1].fwsums,
+				   clip_lval_mod(load_lval(lv, i, q)));
+	}
+
+	memcpy(sums, tm[n].fwsums, sizeof(tm[n].fwsums));
+	gen_mod_norm(sums);
+}
+
+static inline void _bw_m(struct vtrellis *trellis, int n,
+			 const int8_t *z, int16_t *lv, struct tqpp *q)
+{
+	int i;
+	int16_t val;
+	struct tmetric *tm = trellis->tm;
+	SSE_ALIGN int16_t bw[NUM_TRELLIS_STATES];
+
+	memcpy(bw, trellis->bwsums, sizeof(bw));
+	gen_mod_init(bw);
+
+	for (i = n - 1; i >= 0; i--) {
+		val = gen_bw_metrics_mod(tm[i].bm, z[i], tm[i].fwsums, bw);
+		store_lval(lv, i, scale_lval(val, trellis->scale), q);
+	}
+
+	gen_mod_norm(bw);
+	memcpy(trellis->bwsums, bw, sizeof(bw));
+}
+
+/*
+ * Kernel entry points
+ *
+ * Recursions are expanded separately for natural and interleaved L-value
+ * access, which keeps address generation out of the natural order loops.
+ * The addressing state is copied locally so that it can be held in
+ * registers across the vector stores of the recursions.
+ */
+static void fw_r2(struct vtrellis *trellis, int16_t *sums, int n,
+		  const int8_t *x, const int8_t *z, const int16_t *lv,
+		  struct tqpp *q)
+{
+	struct tqpp qpp;
+
+	if (q) {
+		qpp = *q;
+		_fw_r2(trellis, sums, n, x, z, lv, &qpp);
+		*q = qpp;
+	} else {
+		_fw_r2(trellis, sums, n, x, z, lv, NULL);
+	}
+}
+
+static void bw_r2(struct vtrellis *trellis, int n,
+		  const int8_t *z, int16_t *lv, struct tqpp *q)
+{
+	struct tqpp qpp;
+
+	if (q) {
+		qpp = *q;
+		_bw_r2(trellis, n, z, lv, &qpp);
+		*q = qpp;
+	} else {
+		_bw_r2(trellis, n, z, lv, NULL);
+	}
+}
+
+static void fw_r4(struct vtrellis *trellis, int16_t *sums, int n,
+		  const int8_t *x, const int8_t *z, const int16_t *lv,
+		  struct tqpp *q)
+{
+	struct tqpp qpp;
+
+	if (q) {
+		qpp = *q;
+		_fw_r4(trellis, sums, n, x, z, lv, &qpp);
+		*q = qpp;
+	} else {
+		_fw_r4(trellis, sums, n, x, z, lv, NULL);
+	}
+}
+
+static void bw_r4(struct vtrellis *trellis, int n,
+		  const int8_t *z, int16_t *lv, struct tqpp *q)
+{
+	struct tqpp qpp;
+
+	if (q) {
+		qpp = *q;
+		_bw_r4(trellis, n, z, lv, &qpp);
+		*q = qpp;
+	} else {
+		_bw_r4(trellis, n, z, lv, NULL);
+	}
+}
+
+static void fw_lm(struct vtrellis *trellis, int16_t *sums, int n,
+		  const int8_t *x, const int8_t *z, const int16_t *lv,
+		  struct tqpp *q)
+{
+	struct tqpp qpp;
+
+	if (q) {
+		qpp = *q;
+		_fw_lm(trellis, sums, n, x, z, lv, &qpp);
+		*q = qpp;
+	} else {
+		_fw_lm(trellis, sums, n, x, z, lv, NULL);
+	}
+}
+
+static void bw_lm(struct vtrellis *trellis, int n,
+		  const int8_t *z, int16_t *lv, struct tqpp *q)
+{
+	struct tqpp qpp;
+
+	if (q) {
+		qpp = *q;
+		_bw_lm(trellis, n, z, lv, &qpp);
+		*q = qpp;
+	} else {
+		_bw_lm(trellis, n, z, lv, NULL);
+	}
+}
+
+static void fw_m(struct vtrellis *trellis, int16_t *sums, int n,
+		 const int8_t *x, const int8_t *z, const int16_t *lv,
+		 struct tqpp *q)
+{
+	struct tqpp qpp;
+
+	if (q) {
+		qpp = *q;
+		_fw_m(trellis, sums, n, x, z, lv, &qpp);
+		*q = qpp;
+	} else {
+		_fw_m(trellis, sums, n, x, z, lv, NULL);
+	}
+}
+
+static void bw_m(struct vtrellis *trellis, int n,
+		 const int8_t *z, int16_t *lv, struct tqpp *q)
+{
+	struct tqpp qpp;
+
+	if (q) {
+		qpp = *q;
+		_bw_m(trellis, n, z, lv, &qpp);
+		*q = qpp;
+	} else {
+		_bw_m(trellis, n, z, lv, NULL);
+	}
+}
+
+static void x_r2(struct vtrellis *trellis, int16_t *sums, int n,
+		 const int8_t *x, const int8_t *z, int16_t *lv,
+		 struct tqpp *q)
+{
+	struct tqpp qf, qb;
+
+	if (q) {
+		qf = *q;
+		qb = *q;
+		qpp_seek(&qb, qf.i + n - 1);
+		_x_r2(trellis, sums, n, x, z, lv, &qf, &qb);
+	} else {
+		_x_r2(trellis, sums, n, x, z, lv, NULL, NULL);
+	}
+}
+
+static const struct tkernel kernel_r2 = {
+	.fw = fw_r2,
+	.bw = bw_r2,
+};
+
+static const struct tkernel kernel_r4 = {
+	.fw = fw_r4,
+	.bw = bw_r4,
+};
+
+static const struct tkernel kernel_lm = {
+	.fw = fw_lm,
+	.bw = bw_lm,
+};
+
+static const struct tkernel kernel_x = {
+	.fw = fw_r2,
+	.bw = bw_r2,
+	.x = x_r2,
+};
+
+static const struct tkernel kernel_m = {
+	.fw = fw_m,
+	.bw = bw_m,
+};
+
+/*
+ * Pack hard decisions
+ *
+ * Bits are packed most significant bit first in transmission order. Code
+ * block lengths are multiples of 8.
+ */
+static void pack_hard_bits(const int16_t *lvals, int len, uint8_t *bytes)
+{
+	int i, n;
+	uint16_t bits;
+
+	for (i = 0; i < len / 16; i++) {
+		bits = gen_hard_bits(&lvals[16 * i]);
+		bytes[2 * i + 0] = bits;
+		bytes[2 * i + 1] = bits >> 8;
+	}
+
+	for (n = 16 * i; n < len; n++) {
+		if (!(n % 8))
+			bytes[n / 8] = 0;
+		if (lvals[n] > 0)
+			bytes[n / 8] |= 0x80 >> (n % 8);
+	}
+}
+
+/* Early termination check on the CRC of the hard decisions */
+static int check_crc(int crc, const int16_t *lvals, int len)
+{
+	uint8_t bytes[TURBO_MAX_K / 8];
+
+	if (crc == TDEC_CRC_NONE)
+		return 0;
+
+	pack_hard_bits(lvals, len, bytes);
+
+	return !turbo_crc24(crc, bytes, len / 8);
+}
+
+/* Early termination without CRC is enabled */
+static int stop_enabled(const struct tdecoder *dec)
+{
+	return dec->agree || dec->min_lval;
+}
+
+/*
+ * Early termination check without CRC
+ *
+ * Hard decisions of the second constituent decoder, de-interleaved in
+ * 'lvals', are compared with the packed decisions 'bits' of the first
+ * decoder. Alternatively, all L-value magnitudes must exceed the threshold.
+ * Both checks are applied over 'len' values, which may cover a segment of
+ * the code block.
+ */
+static int check_stop(const struct tdecoder *dec, const int16_t *lvals,
+		      const uint8_t *bits, int len)
+{
+	uint8_t bytes[TURBO_MAX_K / 8];
+
+	if (dec->agree) {
+		pack_hard_bits(lvals, len, bytes);
+		if (!memcmp(bytes, bits, len / 8))
+			return 1;
+	}
+
+	if (dec->min_lval && (gen_min_abs(lvals, len) > dec->min_lval))
+		return 1;
+
+	return 0;
+}
+
+/*
+ * Initialize backward metrics at the end of a window ending at step 'end'
+ *
+ * The end of the trellis uses the zero state initialization. Window
+ * boundaries inside the trellis start either from backward training over the
+ * following steps or, without training, from the boundary metrics produced
+ * by the previous iteration. Training starts from equiprobable metrics
+ * unless it ends on another window boundary. When decoding a segment of the
+ * trellis, the segment end starts from the metrics in 'bw_in' instead.
+ * With 'q' set, training reads a-priori values through the interleaved
+ * addressing.
+ */
+static void init_bw(struct tdecoder *dec, struct vtrellis *trellis,
+		    int end, int len, const int8_t *x, const int8_t *z,
+		    const int16_t *lv, const int16_t *bw_in, struct tqpp *q)
+{
+	int i, n;
+
+	if (end == len) {
+		if (bw_in) {
+			memcpy(trellis->bwsums, bw_in, 8 * sizeof(int16_t));
+			return;
+		}
+
+		/* We have enough headroom to not clear all sums */
+		trellis->bwsums[0] = SUM_INIT;
+		return;
+	}
+
+	if (!dec->train) {
+		memcpy(trellis->bwsums, trellis->bnd[end / dec->win],
+		       sizeof(trellis->bnd[0]));
+		return;
+	}
+
+	n = len - end < dec->train ? len - end : dec->train;
+
+	/* Training also starts from boundary metrics when aligned */
+	if (!((end + n) % dec->win) && (end + n < len)) {
+		memcpy(trellis->bwsums, trellis->bnd[(end + n) / dec->win],
+		       sizeof(trellis->bnd[0]));
+	} else if ((end + n == len) && bw_in) {
+		memcpy(trellis->bwsums, bw_in, 8 * sizeof(int16_t));
+	} else {
+		memset(trellis->bwsums, 0, 8 * sizeof(int16_t));
+		if (end + n == len)
+			trellis->bwsums[0] = SUM_INIT;
+	}
+
+	if (q)
+		qpp_seek(q, end + n - 1);
+
+	for (i = end + n - 1; i >= end; i--) {
+		gen_bw_train(x[i], z[i],
+			     q ? qpp_load(q) : lv[i], trellis->bwsums);
+		if (q)
+			qpp_prev(q);
+	}
+}
+
+/*
+ * Constituent decoder iteration
+ *
+ * The trellis is processed in windows of 'win' steps. Forward metrics are
+ * carried across windows, so only backward metrics at window boundaries are
+ * approximated. Without windowing, the entire trellis is a single window.
+ * With 'seg' set, inputs and L-values cover a segment of the trellis, which
+ * starts and ends from the provided boundary metrics. With 'q' set, L-values
+ * of the complete trellis are accessed through the interleaved addressing.
+ * With a synchronization pool set, all participants complete each window
+ * before the next one starts.
+ */
+static int turbo_iterate(struct tdecoder *dec, struct vtrellis *trellis,
+			 int len, const int8_t *x, const int8_t *z,
+			 int16_t *lv, const struct tseg *seg, struct tqpp *q)
+{
+	int i, n, win = dec->win ? dec->win : len;
+	SSE_ALIGN int16_t sums[NUM_TRELLIS_STATES] = { SUM_INIT };
+
+	if (seg && seg->fw_in)
+		memcpy(sums, seg->fw_in, sizeof(sums));
+
+	for (i = 0; i < len; i += win) {
+		n = len - i < win ? len - i : win;
+
+		if (dec->kernel->x) {
+			init_bw(dec, trellis, i + n, len, x, z, lv,
+				seg ? seg->bw_in : NULL, q);
+
+			if (q)
+				qpp_seek(q, i);
+
+			dec->kernel->x(trellis, sums, n,
+				       &x[i], &z[i], &lv[i], q);
+		} else {
+			if (q)
+				qpp_seek(q, i);
+
+			dec->kernel->fw(trellis, sums, n,
+					&x[i], &z[i], &lv[i], q);
+
+			init_bw(dec, trellis, i + n, len, x, z, lv,
+				seg ? seg->bw_in : NULL, q);
+
+			if (q)
+				qpp_seek(q, i + n - 1);
+
+			dec->kernel->bw(trellis, n, &z[i], &lv[i], q);
+		}
+
+		if (dec->win) {
+			memcpy(trellis->bnd[i / win], trellis->bwsums,
+			       sizeof(trellis->bnd[0]));
+		}
+
+		if (seg && !i) {
+			memcpy(seg->bw_out, trellis->bwsums,
+			       sizeof(trellis->bnd[0]));
+		}
+
+		if (dec->sync && (i + n < len))
+			tpool_barrier(dec->sync);
+	}
+
+	if (seg)
+		memcpy(seg->fw_out, sums, sizeof(sums));
+
+	return 0;
+}
+
+/*
+ * 8-bit input scaling
+ *
+ * Channel values are reduced to leave headroom for a-priori values and path
+ * metrics within 8 bits.
+ */
+#define INT8_SHIFT		3
+
+/* 8-bit initial metrics of the zero state */
+static const int8_t init8[NUM_TRELLIS_STATES] = {
+	0, -128, -128, -128, -128, -128, -128, -128,
+};
+
+/*
+ * Pack 8-bit inputs
+ *
+ * A trellis of 'len' stages is split into two segments of 's' stages. The
+ * second segment starts at stage 'len - s' and overlaps the first by one
+ * stage for odd lengths. Scaled systematic and parity values of both
+ * segments are packed for each step.
+ */
+static void pack_inputs8(int len, const int8_t *x, const int8_t *z,
+			 uint32_t *xz)
+{
+	int i, s = (len + 1) / 2, b = len - s;
+
+	for (i = 0; i < s; i++) {
+		xz[i] = (uint8_t) (x[i] >> INT8_SHIFT) |
+			(uint8_t) (x[b + i] >> INT8_SHIFT) << 8 |
+			(uint8_t) (z[i] >> INT8_SHIFT) << 16 |
+			(uint32_t) (uint8_t) (z[b + i] >> INT8_SHIFT) << 24;
+	}
+}
+
+/*
+ * 8-bit constituent decoder iteration
+ *
+ * Both segments of trellis 'k' are decoded in a single pass. The first
+ * segment starts from the zero state and the second segment ends at the
+ * terminated trellis end. At the boundary between segments, each segment
+ * starts from the metrics that the other segment produced in the previous
+ * iteration. Where segments overlap, the second segment provides the
+ * L-value.
+ */
+static int turbo_iterate8(struct tdecoder *dec, int k, int len,
+			  const uint32_t *xz, int16_t *lv)
+{
+	int i, s = (len + 1) / 2, b = len - s;
+	int8_t out[2];
+	uint16_t le;
+	struct tmetric8 *tm = dec->tm8;
+	int8_t *fw = dec->nii8[k][0], *bw = dec->nii8[k][1];
+
+	memcpy(&tm[0].fwsums[0], init8, sizeof(init8));
+	memcpy(&tm[0].fwsums[8], fw, NUM_TRELLIS_STATES);
+
+	for (i = 0; i < s; i++) {
+		le = (uint8_t) (lv[i] >> 1) | (uint8_t) (lv[b + i] >> 1) << 8;
+		gen_fw_metrics8(tm[i].bm, xz[i], le,
+				tm[i].fwsums, tm[i + 1].fwsums);
+	}
+
+	/* Forward metrics of the first segment at the second segment start */
+	memcpy(fw, tm[b].fwsums, NUM_TRELLIS_STATES);
+
+	memcpy(&dec->bwsums8[0], bw, NUM_TRELLIS_STATES);
+	memcpy(&dec->bwsums8[8], init8, sizeof(init8));
+
+	for (i = s - 1; i >= 0; i--) {
+		gen_bw_metrics8(tm[i].bm, xz[i], tm[i].fwsums,
+				dec->bwsums8, out);
+		lv[i] = scale_lval(out[0], dec->trellis[k].scale);
+		lv[b + i] = scale_lval(out[1], dec->trellis[k].scale);
+
+		/* Backward metrics of the second segment at the first end */
+		if (b + i == s)
+			memcpy(bw, &dec->bwsums8[8], NUM_TRELLIS_STATES);
+	}
+
+	return 0;
+}
+
+/* Allocate 8-bit metric storage for two segments of the longest trellis */
+static int alloc_metrics8(struct tdecoder *dec)
+{
+	int len = (MAX_TRELLIS_LEN + 1) / 2 + 1;
+
+#if defined(__MACH__)
+	if (posix_memalign((void **) &dec->tm8, 16,
+			   len * sizeof(struct tmetric8)))
+		return -ENOMEM;
+#else
+	dec->tm8 = (struct tmetric8 *)
+		   memalign(16, len * sizeof(struct tmetric8));
+	if (!dec->tm8)
+		return -ENOMEM;
+#endif
+	return 0;
+}
+
+/*
+ * Decode segment 's' of constituent decoder 'k' for iteration bank 'b'
+ *
+ * Segment metrics are held by the participant decoder while L-values are
+ * shared with the calling decoder.
+ */
+static void par_iterate(struct tparallel *par, struct tdecoder *dec,
+			int k, int s, int b)
+{
+	struct tseg seg;
+	int start = s * par->slen;
+	int n = par->dec[0]->len - start;
+
+	if (n > par->slen)
+		n = par->slen;
+
+	seg.fw_in = s ? par->fw[!b][k][s - 1] : NULL;
+	seg.bw_in = s < par->num - 1 ? par->bw[!b][k][s + 1] : NULL;
+	seg.fw_out = par->fw[b][k][s];
+	seg.bw_out = par->bw[b][k][s];
+
+	turbo_iterate(dec, &dec->trellis[k], n,
+		      &par->x[k][start], &par->z[k][start],
+		      &par->dec[0]->trellis[k].lvals[start], &seg, NULL);
+}
+
+/*
+ * Parallel segment job
+ *
+ * Each participant decodes its own segment and then interleaves the
+ * L-values for its own segment of the other constituent decoder. The
+ * interleavers gather from the complete trellis, so a barrier is only
+ * required between half-iterations. Participants without a segment only
+ * take part in the barriers.
+ *
+ * With early termination, every participant checks the complete output of
+ * the first constituent decoder after the barrier, which leaves all
+ * participants with the same result without further synchronization. The
+ * de-interleaved output of the second decoder is not checked because it is
+ * only complete once the next iteration has started.
+ *
+ * Early termination without CRC is checked by each participant over its own
+ * segment, where it writes the de-interleaved output itself. Results are
+ * combined after an additional barrier.
+ */
+static void par_job(void *arg, int idx)
+{
+	int i, j, n, start, active;
+	struct tparallel *par = (struct tparallel *) arg;
+	struct tdecoder *dec = par->dec[idx];
+	struct vtrellis *trellis = par->dec[0]->trellis;
+
+	start = idx * par->slen;
+	active = idx < par->num;
+
+	/* Message bits of the segment */
+	n = par->len - start;
+	if (n > par->slen)
+		n = par->slen;
+	if (n < 0)
+		n = 0;
+
+	for (i = 0; i < par->iter; i++) {
+		if (par->apri) {
+			memcpy(&par->apri[start], &trellis[0].lvals[start],
+			       n * sizeof(int16_t));
+		}
+
+		if (active)
+			par_iterate(par, dec, 0, idx, i % 2);
+
+		tpool_barrier(par->pool);
+
+		if (check_crc(dec->crc, trellis[0].lvals, par->len)) {
+			if (!idx)
+				par->used = i + 1;
+			return;
+		}
+
+		if (par->apri) {
+			memcpy(&par->apri[start], &trellis[0].lvals[start],
+			       n * sizeof(int16_t));
+		}
+
+		if (active) {
+			if (dec->agree) {
+				pack_hard_bits(&trellis[0].lvals[start], n,
+					       &par->bits[start / 8]);
+			}
+			turbo_interleave_lval_seg(par->len, start, par->slen,
+						  trellis[0].lvals,
+						  trellis[1].lvals);
+			par_iterate(par, dec, 1, idx, i % 2);
+		}
+
+		tpool_barrier(par->pool);
+
+		if (active) {
+			turbo_deinterleave_lval_seg(par->len, start, par->slen,
+						    trellis[1].lvals,
+						    trellis[0].lvals);
+		}
+
+		if (!stop_enabled(dec))
+			continue;
+
+		par->stop[idx] = check_stop(dec, &trellis[0].lvals[start],
+					    &par->bits[start / 8], n);
+
+		tpool_barrier(par->pool);
+
+		for (j = 0; j < tpool_size(par->pool); j++) {
+			if (!par->stop[j])
+				break;
+		}
+
+		if (j == tpool_size(par->pool)) {
+			if (!idx)
+				par->used = i + 1;
+			return;
+		}
+	}
+}
+
+/*
+ * Parallel segment decoding
+ *
+ * Segment lengths are kept at multiples of 8 steps, which may leave fewer
+ * segments than pool participants for short code blocks.
+ */
+static int par_decode(struct tdecoder *dec, int len, int iter,
+		      const int8_t *x, const int8_t *z,
+		      const int8_t *xp, const int8_t *zp, int16_t *apri,
+		      int *done)
+{
+	int i;
+	struct tparallel *par = dec->par;
+	int num = tpool_size(par->pool);
+
+	par->len = len;
+	par->iter = iter;
+	par->used = 0;
+	par->slen = ((dec->len + num - 1) / num + 7) & ~7;
+	par->num = (dec->len + par->slen - 1) / par->slen;
+	par->x[0] = x;
+	par->z[0] = z;
+	par->x[1] = xp;
+	par->z[1] = zp;
+	par->apri = apri;
+
+	memset(par->fw, 0, sizeof(par->fw));
+	memset(par->bw, 0, sizeof(par->bw));
+
+	for (i = 1; i < par->num; i++)
+		init_tdec(par->dec[i], par->slen);
+
+	tpool_run(par->pool, par_job, par);
+
+	*done = par->used != 0;
+
+	return *done ? par->used : iter;
+}
+
+/*
+ * Shuffled decoding job
+ *
+ * Participant 'idx' runs constituent decoder 'idx' for all iterations. The
+ * first decoder reads the natural order output of the second decoder and
+ * writes its own output to 'ext', which the second decoder reads through
+ * the interleaved addressing. Both decoders advance window by window in
+ * lockstep, so that output of earlier windows of the current iteration is
+ * available to the other decoder regardless of thread scheduling. Early
+ * termination is checked by participant 0 while both outputs are complete,
+ * and the result is passed on with a second barrier.
+ */
+static void shuf_job(void *arg, int idx)
+{
+	int i;
+	uint8_t bits[TURBO_MAX_K / 8];
+	struct tqpp q;
+	struct tshuffle *shuf = (struct tshuffle *) arg;
+	struct tdecoder *dec = shuf->dec[idx];
+	struct vtrellis *trellis = &dec->trellis[idx];
+	int16_t *lv = shuf->dec[0]->trellis[0].lvals;
+
+	for (i = 0; i < shuf->iter; i++) {
+		if (!idx) {
+			qpp_init_natural(&q, shuf->len, lv, shuf->ext);
+			q.ext = shuf->ext;
+		} else {
+			/* Unsupported lengths have no interleaver */
+			if (qpp_init(&q, shuf->len, shuf->ext,
+				     trellis->lvals) < 0) {
+				qpp_init_natural(&q, shuf->len, shuf->ext,
+						 trellis->lvals);
+			}
+			q.ext = lv;
+		}
+
+		turbo_iterate(dec, trellis, dec->len, shuf->x[idx],
+			      shuf->z[idx], trellis->lvals, NULL, &q);
+
+		tpool_barrier(shuf->pool);
+
+		if (!dec->crc && !stop_enabled(dec))
+			continue;
+
+		if (!idx) {
+			if (dec->agree)
+				pack_hard_bits(shuf->ext, shuf->len, bits);
+
+			shuf->stop = check_crc(dec->crc, lv, shuf->len) ||
+				     (stop_enabled(dec) &&
+				      check_stop(dec, lv, bits, shuf->len));
+		}
+
+		tpool_barrier(shuf->pool);
+
+		if (shuf->stop) {
+			if (!idx)
+				shuf->used = i + 1;
+			return;
+		}
+	}
+}
+
+/*
+ * Shuffled decoding
+ *
+ * Output is taken from the second constituent decoder in natural order as
+ * with serial decoding. The a-priori values of that decoder are the output
+ * of the first decoder.
+ */
+static int shuf_decode(struct tdecoder *dec, int len, int iter,
+		       const int8_t *x, const int8_t *z,
+		       const int8_t *xp, const int8_t *zp, int16_t *apri,
+		       int *done)
+{
+	struct tshuffle *shuf = dec->shuf;
+
+	shuf->len = len;
+	shuf->iter = iter;
+	shuf->used = 0;
+	shuf->stop = 0;
+	shuf->x[0] = x;
+	shuf->z[0] = z;
+	shuf->x[1] = xp;
+	shuf->z[1] = zp;
+
+	memset(shuf->ext, 0, dec->len * sizeof(int16_t));
+	init_tdec(shuf->dec[1], dec->len);
+
+	shuf->dec[0]->sync = shuf->pool;
+	shuf->dec[1]->sync = shuf->pool;
+
+	tpool_run(shuf->pool, shuf_job, shuf);
+
+	shuf->dec[0]->sync = NULL;
+	shuf->dec[1]->sync = NULL;
+
+	if (apri)
+		memcpy(apri, shuf->ext, len * sizeof(int16_t));
+
+	*done = shuf->used != 0;
+
+	return *done ? shuf->used : iter;
+}
+
+/*
+ * Decoder inputs
+ *
+ * x, z      - Systematic and parity inputs of the first constituent decoder
+ * xp, zp    - Systematic and parity inputs of the second constituent decoder
+ * xz        - Packed 8-bit inputs of both constituent decoders
+ */
+struct tinput {
+	const int8_t *x;
+	const int8_t *z;
+	const int8_t *xp;
+	const int8_t *zp;
+	const uint32_t *xz[2];
+};
+
+/*
+ * Reverse termination and interleaving on local copies of the inputs
+ *
+ * Systematic inputs of known bits are pinned to saturation before
+ * interleaving, which places them at the interleaved positions of the
+ * second constituent decoder as well.
+ */
+static void prep_inputs(int len, const int8_t *known, const int8_t *d0,
+			const int8_t *d1, const int8_t *d2, int8_t *x,
+			int8_t *z, int8_t *xp, int8_t *zp)
+{
+	int i;
+
+	memcpy(x, d0, len + 4);
+	memcpy(z, d1, len + 4);
+	memcpy(zp, d2, len + 4);
+
+	for (i = 0; known && (i < len); i++) {
+		if (known[i])
+			x[i] = known[i] * INT8_MAX;
+	}
+
+	turbo_interleave(len, (uint8_t *) x, (uint8_t *) xp);
+	turbo_unterm(len, (uint8_t *) x, (uint8_t *) z,
+		     (uint8_t *) zp, (uint8_t *) xp);
+}
+
+/*
+ * 8-bit L-value exchange
+ *
+ * Exchanged L-values are held in 8 bits through the natural and interleaved
+ * addressing of both constituent decoders, which halves the footprint of
+ * the random accesses of the second decoder. Recursions still run on 16-bit
+ * metrics. Only serial decoding of block sizes with an interleaver uses the
+ * 8-bit values, which are expanded into the 16-bit L-values for early
+ * termination checks and output.
+ */
+static int lv8_enabled(const struct tdecoder *dec, int len)
+{
+	int f1, f2;
+
+	return dec->lvals8 && !dec->int8 &&
+	       (turbo_interleave_qpp(len, &f1, &f2) >= 0);
+}
+
+static void expand_lvals8(struct tdecoder *dec, int len)
+{
+	int i;
+
+	for (i = 0; i < len; i++)
+		dec->trellis[0].lvals[i] = dec->lvals8[i] << dec->lv8_shift;
+}
+
+/*
+ * Single turbo iteration
+ *
+ * Runs both constituent decoders unless an early termination check passes
+ * after the first one, in which case 'done' is set. Returns the number of
+ * half-iterations run. If 'apri' is set, the a-priori values of the last
+ * constituent decoder that ran are returned in natural order. With 'int8'
+ * set, the 8-bit recursions run instead of the recursion kernel. Except
+ * for the 8-bit recursions, the second decoder works in place on the
+ * natural order L-values through the interleaved addressing.
+ */
+static int turbo_iter(struct tdecoder *dec, int len, int int8,
+		      const struct tinput *in, int16_t *apri, int *done)
+{
+	int rc, sync = dec->crc || stop_enabled(dec) || apri;
+	uint8_t bits[len / 8];
+	struct tqpp q;
+	struct vtrellis *trellis = dec->trellis;
+
+	*done = 0;
+
+	if (apri)
+		memcpy(apri, trellis[0].lvals, len * sizeof(int16_t));
+
+	if (int8) {
+		turbo_iterate8(dec, 0, dec->len, in->xz[0], trellis[0].lvals);
+	} else if (lv8_enabled(dec, len)) {
+		qpp_init_natural(&q, len, trellis[0].lvals, trellis[0].lvals);
+		q.lv8 = dec->lvals8;
+		q.shift = dec->lv8_shift;
+		turbo_iterate(dec, &trellis[0], dec->len, in->x, in->z,
+			      trellis[0].lvals, NULL, &q);
+		if (sync)
+			expand_lvals8(dec, len);
+	} else {
+		turbo_iterate(dec, &trellis[0], dec->len, in->x, in->z,
+			      trellis[0].lvals, NULL, NULL);
+	}
+	if (check_crc(dec->crc, trellis[0].lvals, len)) {
+		*done = 1;
+		return 1;
+	}
+
+	if (dec->agree)
+		pack_hard_bits(trellis[0].lvals, len, bits);
+	if (apri)
+		memcpy(apri, trellis[0].lvals, len * sizeof(int16_t));
+
+	if (int8) {
+		turbo_interleave_lval(len, trellis[0].lvals, trellis[1].lvals);
+		turbo_iterate8(dec, 1, dec->len, in->xz[1], trellis[1].lvals);
+		turbo_deinterleave_lval(len, trellis[1].lvals,
+					trellis[0].lvals);
+	} else {
+		/* Unsupported lengths have no interleaver */
+		rc = qpp_init(&q, len, trellis[0].lvals, trellis[1].lvals);
+		if (lv8_enabled(dec, len)) {
+			q.lv8 = dec->lvals8;
+			q.shift = dec->lv8_shift;
+		}
+
+		turbo_iterate(dec, &trellis[1], dec->len, in->xp, in->zp,
+			      trellis[1].lvals, NULL, rc < 0 ? NULL : &q);
+
+		if (sync && lv8_enabled(dec, len))
+			expand_lvals8(dec, len);
+	}
+
+	if (check_crc(dec->crc, trellis[0].lvals, len) ||
+	    (stop_enabled(dec) &&
+	     check_stop(dec, trellis[0].lvals, bits, len)))
+		*done = 1;
+
+	return 2;
+}
+
+/*
+ * Mixed precision
+ *
+ * L-values of the 8-bit recursions are on the reduced input scale. When
+ * switching between 8-bit and 16-bit recursions, L-values of both trellis
+ * ends and 8-bit exchanged L-values are rescaled. Switching up, values are
+ * also halved, since the saturating 8-bit recursions overstate reliability
+ * and the 16-bit iterations otherwise recover slowly from wrong decisions.
+ */
+#define INT8_UP_SHIFT		(INT8_SHIFT - 1)
+
+static void rescale_lvals(struct tdecoder *dec, int len, int up)
+{
+	int i;
+	int16_t *lv0 = dec->trellis[0].lvals, *lv1 = dec->trellis[1].lvals;
+
+	for (i = 0; i < dec->len; i++) {
+		lv0[i] = up ? lv0[i] * (1 << INT8_UP_SHIFT) :
+			      lv0[i] >> INT8_SHIFT;
+	}
+	for (i = len; i < dec->len; i++) {
+		lv1[i] = up ? lv1[i] * (1 << INT8_UP_SHIFT) :
+			      lv1[i] >> INT8_SHIFT;
+	}
+
+	if (up && lv8_enabled(dec, len)) {
+		for (i = 0; i < len; i++)
+			dec->lvals8[i] = pack_lval8(lv0[i], dec->lv8_shift);
+	}
+}
+
+/*
+ * Single code block decoding
+ *
+ * Returns the number of iterations run. An iteration stopped after the
+ * first constituent decoder counts as a complete iteration. If 'prior' is
+ * set, decoding starts from these a-priori values of the first constituent
+ * decoder instead of zero. If 'apri' is set, the a-priori values of the
+ * last constituent decoder that ran are returned in natural order. If
+ * 'next' is set, the a-priori values of the first constituent decoder for
+ * a further iteration are returned before known bits are applied. After a
+ * stop at the first decoder, these are the values that decoder started
+ * from. 'next' may alias 'prior'. If 'conv' is set, it reports whether an
+ * early termination check passed. With mixed precision, the first
+ * iterations run the 8-bit recursions and output, including 'apri' and
+ * 'next', is always returned on the 16-bit scale.
+ */
+static inline int _turbo_decode(struct tdecoder *dec, int len, int iter,
+				const int8_t *d0, const int8_t *d1,
+				const int8_t *d2, const int16_t *prior,
+				int16_t *apri, int16_t *next, int *conv)
+{
+	int i, n, int8, halves = 2, done = 0;
+	int16_t *ap = apri ? apri : next;
+	int8_t x[len + 4], z[len + 4], zp[len + 4], xp[len + 4];
+	uint32_t xz[2][(len + 4) / 2];
+	struct tinput in = {
+		.x = x, .z = z, .xp = xp, .zp = zp,
+		.xz = { xz[0], xz[1] },
+	};
+
+	prep_inputs(len, dec->known, d0, d1, d2, x, z, xp, zp);
+	init_tdec(dec, len + 3);
+
+	if (prior)
+		memcpy(dec->trellis[0].lvals, prior, len * sizeof(int16_t));
+	if (prior && lv8_enabled(dec, len)) {
+		for (n = 0; n < len; n++)
+			dec->lvals8[n] = pack_lval8(prior[n], dec->lv8_shift);
+	}
+
+	if (!dec->int8 && dec->par) {
+		i = par_decode(dec, len, iter, x, z, xp, zp, apri, &done);
+		goto out;
+	} else if (!dec->int8 && dec->shuf) {
+		i = shuf_decode(dec, len, iter, x, z, xp, zp, apri, &done);
+		goto out;
+	}
+
+	int8 = dec->int8 || dec->int8_iter;
+	if (int8) {
+		if (!dec->tm8 && (alloc_metrics8(dec) < 0))
+			return -ENOMEM;
+
+		pack_inputs8(dec->len, x, z, xz[0]);
+		pack_inputs8(dec->len, xp, zp, xz[1]);
+	}
+
+	if (int8 && !dec->int8 && prior)
+		rescale_lvals(dec, len, 0);
+
+	for (i = 0; i < iter; i++) {
+		if (int8 && !dec->int8 && (i == dec->int8_iter)) {
+			rescale_lvals(dec, len, 1);
+			int8 = 0;
+		}
+
+		halves = turbo_iter(dec, len, int8, &in, ap, &done);
+		if (done) {
+			i++;
+			break;
+		}
+	}
+
+	if (int8 && !dec->int8) {
+		rescale_lvals(dec, len, 1);
+		for (n = 0; ap && (n < len); n++)
+			ap[n] *= 1 << INT8_UP_SHIFT;
+	} else if (!int8 && lv8_enabled(dec, len)) {
+		expand_lvals8(dec, len);
+	}
+out:
+	if (next && (halves == 2))
+		memcpy(next, dec->trellis[0].lvals, len * sizeof(int16_t));
+	else if (next && (next != ap))
+		memcpy(next, ap, len * sizeof(int16_t));
+
+	/* Known bits are output as decided */
+	for (n = 0; dec->known && (n < len); n++) {
+		if (dec->known[n])
+			dec->trellis[0].lvals[n] = dec->known[n] * INT16_MAX;
+	}
+
+	if (conv)
+		*conv = done;
+
+	return i;
+}
+
+#define SLICE_PACK_LE(X,I) \
+	((X[I + 0] > 0 ? 1 : 0) << 0) | \
+	((X[I + 1] > 0 ? 1 : 0) << 1) | \
+	((X[I + 2] > 0 ? 1 : 0) << 2) | \
+	((X[I + 3] > 0 ? 1 : 0) << 3) | \
+	((X[I + 4] > 0 ? 1 : 0) << 4) | \
+	((X[I + 5] > 0 ? 1 : 0) << 5) | \
+	((X[I + 6] > 0 ? 1 : 0) << 6) | \
+	((X[I + 7] > 0 ? 1 : 0) << 7)
+
+#define SLICE_PACK_BE(X,I) \
+	((X[I + 0] > 0 ? 1 : 0) << 7) | \
+	((X[I + 1] > 0 ? 1 : 0) << 6) | \
+	((X[I + 2] > 0 ? 1 : 0) << 5) | \
+	((X[I + 3] > 0 ? 1 : 0) << 4) | \
+	((X[I + 4] > 0 ? 1 : 0) << 3) | \
+	((X[I + 5] > 0 ? 1 : 0) << 2) | \
+	((X[I + 6] > 0 ? 1 : 0) << 1) | \
+	((X[I + 7] > 0 ? 1 : 0) << 0)
+/*
+ * Default to big endian byte packing
+ */
+#ifdef PACK_LE
+#define SLICE_PACK	SLICE_PACK_LE
+#else
+#define SLICE_PACK	SLICE_PACK_BE
+#endif
+
+static void pack_lvals(const int16_t *lvals, int len, uint8_t *output)
+{
+	int i;
+
+	for (i = 0; i < len / 8; i++)
+		output[i] = SLICE_PACK(lvals, 8 * i);
+}
+
+API_EXPORT
+int lte_turbo_decode(struct tdecoder *dec,
+		     int len, int iter, uint8_t *output,
+		     const int8_t *d0, const int8_t *d1, const int8_t *d2)
+{
+	int rc;
+
+	if ((len < TURBO_MIN_K) || len > TURBO_MAX_K)
+		return -EINVAL;
+
+	rc = _turbo_decode(dec, len, iter, d0, d1, d2, NULL, NULL, NULL, NULL);
+	if (rc < 0)
+		return rc;
+
+	pack_lvals(dec->trellis[0].lvals, len, output);
+
+	return rc;
+}
+
+API_EXPORT
+int lte_turbo_decode_unpack(struct tdecoder *dec,
+			   int len, int iter, uint8_t *output,
+			   const int8_t *d0, const int8_t *d1, const int8_t *d2)
+{
+	int i, rc;
+
+	if ((len < TURBO_MIN_K) || len > TURBO_MAX_K)
+		return -EINVAL;
+
+	rc = _turbo_decode(dec, len, iter, d0, d1, d2, NULL, NULL, NULL, NULL);
+	if (rc < 0)
+		return rc;
+
+	for (i = 0; i < len; i++)
+		output[i] = dec->trellis[0].lvals[i] > 0 ? 1 : 0;
+
+	return rc;
+}
+
+/*
+ * Retransmission decoding
+ *
+ * After an iteration that runs both constituent decoders, the natural order
+ * L-values are the a-priori input of the first decoder for the next
+ * iteration. Saving them lets a later attempt on combined inputs of the
+ * same code block continue from there instead of from zero.
+ */
+API_EXPORT
+int lte_turbo_decode_harq(struct tdecoder *dec, int len, int iter,
+			  uint8_t *output, int16_t *lvals, const int8_t *d0,
+			  const int8_t *d1, const int8_t *d2)
+{
+	int rc;
+
+	if ((len < TURBO_MIN_K) || len > TURBO_MAX_K)
+		return -EINVAL;
+
+	rc = _turbo_decode(dec, len, iter, d0, d1, d2, lvals, NULL, lvals,
+			   NULL);
+	if (rc < 0)
+		return rc;
+
+	pack_lvals(dec->trellis[0].lvals, len, output);
+
+	return rc;
+}
+
+/* Decode a single TTI code block, setting its iteration count and status */
+int tdec_decode_block(struct tdecoder *dec, int iter,
+		      struct lte_turbo_tti_block *blk)
+{
+	int rc, conv;
+
+	if ((blk->len < TURBO_MIN_K) || (blk->len > TURBO_MAX_K))
+		return -EINVAL;
+
+	rc = _turbo_decode(dec, blk->len, iter, blk->d0, blk->d1, blk->d2,
+			   NULL, NULL, NULL, &conv);
+	if (rc < 0)
+		return rc;
+
+	pack_lvals(dec->trellis[0].lvals, blk->len, blk->output);
+
+	blk->iter = rc;
+	blk->status = conv ? TDEC_BLOCK_CONVERGED : TDEC_BLOCK_MAX_ITER;
+
+	return 0;
+}
+
+/*
+ * Soft output decoding
+ *
+ * Extrinsic L-values are the output of the last constituent decoder that
+ * ran. A-posteriori L-values add the systematic channel values and the
+ * a-priori input of that decoder, using the scale of the extrinsic values.
+ * Systematic values of known bits are pinned to saturation as on input to
+ * the decoders.
+ */
+API_EXPORT
+int lte_turbo_decode_soft(struct tdecoder *dec, int len, int iter,
+			  int16_t *app, int16_t *ext,
+			  const int8_t *d0, const int8_t *d1, const int8_t *d2)
+{
+	int i, rc, l, x, shift;
+	const int16_t *lvals = dec->trellis[0].lvals;
+
+	if ((len < TURBO_MIN_K) || len > TURBO_MAX_K)
+		return -EINVAL;
+
+	int16_t apri[len];
+
+	memset(apri, 0, len * sizeof(int16_t));
+
+	rc = _turbo_decode(dec, len, iter, d0, d1, d2, NULL, apri, NULL, NULL);
+	if (rc < 0)
+		return rc;
+
+	/*
+	 * L-values are on the reduced scale only if the 8-bit kernel ran the
+	 * last iteration. Mixed precision returns both a-priori and extrinsic
+	 * values on the 16-bit scale, also when it stops in 8-bit iterations.
+	 */
+	shift = dec->int8 ? INT8_SHIFT : 0;
+
+	if (ext)
+		memcpy(ext, lvals, len * sizeof(int16_t));
+
+	if (!app)
+		return rc;
+
+	for (i = 0; i < len; i++) {
+		x = d0[i];
+		if (dec->known && dec->known[i])
+			x = dec->known[i] * INT8_MAX;
+
+		l = 2 * (x >> shift) + apri[i] + lvals[i];
+		if (l > INT16_MAX)
+			l = INT16_MAX;
+		else if (l < -INT16_MAX)
+			l = -INT16_MAX;
+		app[i] = l;
+	}
+
+	return rc;
+}
+
+/*
+ * Constituent decoder
+ *
+ * Runs on the first trellis with natural order L-values. An unterminated
+ * trellis starts the backward recursion from equal metrics in place of the
+ * zero state, through the boundary input of a segment that ends the
+ * trellis.
+ */
+API_EXPORT
+int lte_turbo_siso(struct tdecoder *dec, int len, int term,
+		   const int8_t *x, const int8_t *z,
+		   const int16_t *apri, int16_t *ext)
+{
+	int n = term ? len + 3 : len;
+	int16_t *lvals = dec->trellis[0].lvals;
+	int16_t bw_in[NUM_TRELLIS_STATES] = { 0 };
+	int16_t fw_out[NUM_TRELLIS_STATES], bw_out[NUM_TRELLIS_STATES];
+	struct tseg seg = {
+		.bw_in = bw_in,
+		.fw_out = fw_out,
+		.bw_out = bw_out,
+	};
+
+	if ((len < 1) || (len > TURBO_MAX_K) || dec->int8)
+		return -EINVAL;
+
+	init_tdec(dec, n);
+	if (apri)
+		memcpy(lvals, apri, len * sizeof(int16_t));
+
+	turbo_iterate(dec, &dec->trellis[0], n, x, z, lvals,
+		      term ? NULL : &seg, NULL);
+
+	memcpy(ext, lvals, len * sizeof(int16_t));
+
+	return 0;
+}
+
+/* Max number of window boundaries per trellis */
+#define MAX_WINDOWS	((MAX_TRELLIS_LEN + TDEC_MIN_WINDOW - 1) / TDEC_MIN_WINDOW)
+
+/*
+ * Code block iteration state
+ *
+ * Holds the prepared inputs and everything that the decoder carries from
+ * one iteration to the next, so that decoding can switch between the code
+ * blocks of a TTI after any iteration. Second decoder L-values are
+ * regenerated by the interleaver on every iteration except for the tail.
+ * With 8-bit exchange, the 8-bit L-values carry the state between
+ * iterations and the 16-bit L-values are expanded from them for output.
+ */
+struct tstate {
+	int8_t x[TURBO_MAX_K + 4];
+	int8_t z[TURBO_MAX_K + 4];
+	int8_t xp[TURBO_MAX_K + 4];
+	int8_t zp[TURBO_MAX_K + 4];
+	int16_t lvals[MAX_TRELLIS_LEN];
+	int8_t lvals8[MAX_TRELLIS_LEN];
+	int16_t tail[3];
+	int16_t bwsums[NUM_TRELLIS_STATES];
+	int16_t bnd[2][MAX_WINDOWS][NUM_TRELLIS_STATES];
+	int8_t nii8[2][2][NUM_TRELLIS_STATES];
+};
+
+/* Copy iteration state of a code block of length 'len' into the decoder */
+static void load_state(struct tdecoder *dec, const struct tstate *st,
+		       int len)
+{
+	int num;
+	struct vtrellis *trellis = dec->trellis;
+
+	dec->len = len + 3;
+
+	memcpy(trellis[0].lvals, st->lvals, dec->len * sizeof(int16_t));
+	memcpy(&trellis[1].lvals[len], st->tail, sizeof(st->tail));
+	if (dec->lvals8)
+		memcpy(dec->lvals8, st->lvals8, len * sizeof(int8_t));
+	memcpy(dec->bwsums, st->bwsums, sizeof(st->bwsums));
+	memcpy(dec->nii8, st->nii8, sizeof(st->nii8));
+
+	if (dec->win) {
+		num = (dec->len + dec->win - 1) / dec->win;
+		memcpy(trellis[0].bnd, st->bnd[0], num * sizeof(*trellis[0].bnd));
+		memcpy(trellis[1].bnd, st->bnd[1], num * sizeof(*trellis[1].bnd));
+	}
+}
+
+/* Copy iteration state of the current code block out of the decoder */
+static void store_state(const struct tdecoder *dec, struct tstate *st)
+{
+	int num, len = dec->len - 3;
+	const struct vtrellis *trellis = dec->trellis;
+
+	memcpy(st->lvals, trellis[0].lvals, dec->len * sizeof(int16_t));
+	memcpy(st->tail, &trellis[1].lvals[len], sizeof(st->tail));
+	if (dec->lvals8)
+		memcpy(st->lvals8, dec->lvals8, len * sizeof(int8_t));
+	memcpy(st->bwsums, dec->bwsums, sizeof(st->bwsums));
+	memcpy(st->nii8, dec->nii8, sizeof(st->nii8));
+
+	if (dec->win) {
+		num = (dec->len + dec->win - 1) / dec->win;
+		memcpy(st->bnd[0], trellis[0].bnd, num * sizeof(*trellis[0].bnd));
+		memcpy(st->bnd[1], trellis[1].bnd, num * sizeof(*trellis[1].bnd));
+	}
+}
+
+static long elapsed_usec(const struct timespec *t0)
+{
+	struct timespec t1;
+
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+
+	return (t1.tv_sec - t0->tv_sec) * 1000000 +
+	       (t1.tv_nsec - t0->tv_nsec) / 1000;
+}
+
+/*
+ * Decode code blocks of a TTI under a shared iteration budget
+ *
+ * Each round runs one iteration on every code block that has neither passed
+ * an early termination check nor reached the iteration limit. Blocks that
+ * converge early leave the remaining budget to the harder blocks. A round is
+ * cut short when the budget cannot cover another full iteration. Parallel
+ * segment decoding does not apply. Mixed precision, known bits and shuffled
+ * decoding are rejected. Iteration state takes about 55 kB per code block.
+ */
+API_EXPORT
+int lte_turbo_decode_tti(struct tdecoder *dec, int n, int iter,
+			 int budget, int usec,
+			 struct lte_turbo_tti_block *blk)
+{
+	int i, len, done, active, used = 0;
+	struct tstate *st;
+	struct tinput in;
+	struct timespec t0;
+	uint32_t xz[2][(TURBO_MAX_K + 4) / 2];
+
+	if ((n < 0) || (iter < 0) || (budget < 0) || (usec < 0))
+		return -EINVAL;
+
+	if (dec->int8_iter || dec->known || dec->shuf)
+		return -EINVAL;
+
+	for (i = 0; i < n; i++) {
+		if ((blk[i].len < TURBO_MIN_K) || (blk[i].len > TURBO_MAX_K))
+			return -EINVAL;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+
+	if (n > dec->num_state) {
+		st = (struct tstate *) realloc(dec->state, n * sizeof(*st));
+		if (!st)
+			return -ENOMEM;
+		dec->state = st;
+		dec->num_state = n;
+	}
+
+	if (dec->int8 && !dec->tm8 && (alloc_metrics8(dec) < 0))
+		return -ENOMEM;
+
+	in.xz[0] = xz[0];
+	in.xz[1] = xz[1];
+
+	for (i = 0; i < n; i++) {
+		st = &dec->state[i];
+		len = blk[i].len;
+
+		prep_inputs(len, NULL, blk[i].d0, blk[i].d1, blk[i].d2,
+			    st->x, st->z, st->xp, st->zp);
+		init_tdec(dec, len + 3);
+		store_state(dec, st);
+
+		blk[i].iter = 0;
+		blk[i].status = iter ? TDEC_BLOCK_BUDGET : TDEC_BLOCK_MAX_ITER;
+	}
+
+	do {
+		active = 0;
+
+		for (i = 0; i < n; i++) {
+			if (blk[i].status != TDEC_BLOCK_BUDGET)
+				continue;
+
+			if ((budget && (budget - used < 2)) ||
+			    (usec && (elapsed_usec(&t0) >= usec)))
+				goto out;
+
+			st = &dec->state[i];
+			len = blk[i].len;
+
+			in.x = st->x;
+			in.z = st->z;
+			in.xp = st->xp;
+			in.zp = st->zp;
+
+			load_state(dec, st, len);
+			if (dec->int8) {
+				pack_inputs8(dec->len, st->x, st->z, xz[0]);
+				pack_inputs8(dec->len, st->xp, st->zp, xz[1]);
+			}
+
+			used += turbo_iter(dec, len, dec->int8, &in,
+					   NULL, &done);
+			if (lv8_enabled(dec, len))
+				expand_lvals8(dec, len);
+			store_state(dec, st);
+
+			blk[i].iter++;
+
+			if (done)
+				blk[i].status = TDEC_BLOCK_CONVERGED;
+			else if (blk[i].iter == iter)
+				blk[i].status = TDEC_BLOCK_MAX_ITER;
+			else
+				active = 1;
+		}
+	} while (active);
+out:
+	for (i = 0; i < n; i++)
+		pack_lvals(dec->state[i].lvals, blk[i].len, blk[i].output);
+
+	return used;
+}
+
+#ifdef HAVE_AVX2
+/* Allocate paired decoder state */
+static struct tdecoder2 *alloc_tdec2()
+{
+	struct tdecoder2 *dec;
+
+#if defined(__MACH__)
+	if (posix_memalign((void **) &dec, 32, sizeof(struct tdecoder2)))
+		return NULL;
+#else
+	dec = (struct tdecoder2 *) memalign(32, sizeof(struct tdecoder2));
+	if (!dec)
+		return NULL;
+#endif
+	memset(dec->tm[0].fwsums, 0, 16 * sizeof(int16_t));
+	memset(dec->bwsums, 0, 16 * sizeof(int16_t));
+
+	dec->tm[0].fwsums[0] = SUM_INIT;
+	dec->tm[0].fwsums[8] = SUM_INIT;
+
+	return dec;
+}
+
+static int turbo_iterate2(struct tdecoder2 *dec,
+			  struct vtrellis2 *trellis, int len)
+{
+	int i;
+	struct tmetric2 *tm = dec->tm;
+
+	dec->bwsums[0] = SUM_INIT;
+	dec->bwsums[8] = SUM_INIT;
+
+	/* Forward */
+	for (i = 0; i < len; i++) {
+		gen_fw_metrics2(tm[i].bm, trellis->xz[i],
+				trellis->lvals[i],
+				tm[i].fwsums, tm[i + 1].fwsums,
+				dec->fwnorm[i]);
+	}
+
+	/* Backward */
+	for (i = len - 1; i >= 0; i--) {
+		gen_bw_metrics2(tm[i].bm, trellis->xz[i],
+				tm[i].fwsums, dec->bwsums,
+				dec->fwnorm[i], trellis->lvals[i]);
+	}
+
+	return 0;
+}
+
+/*
+ * Load soft inputs of one code block into lane 'n' of the paired trellis.
+ * Termination is reversed on local copies so input buffers are untouched.
+ */
+static void load_pair(struct tdecoder2 *dec, int len, int n,
+		      const struct lte_turbo_block *blk)
+{
+	int i;
+	int8_t d0[len + 4], d1[len + 4], d2[len + 4], d0p[len + 3];
+	struct vtrellis2 *trellis = dec->trellis;
+
+	memcpy(d0, blk->d0, len + 4);
+	memcpy(d1, blk->d1, len + 4);
+	memcpy(d2, blk->d2, len + 4);
+
+	turbo_interleave(len, (uint8_t *) d0, (uint8_t *) d0p);
+	turbo_unterm(len, (uint8_t *) d0, (uint8_t *) d1,
+		     (uint8_t *) d2, (uint8_t *) d0p);
+
+	for (i = 0; i < len + 3; i++) {
+		trellis[0].xz[i][n + 0] = d0[i];
+		trellis[0].xz[i][n + 2] = d1[i];
+		trellis[1].xz[i][n + 0] = d0p[i];
+		trellis[1].xz[i][n + 2] = d2[i];
+	}
+}
+
+static void _turbo_decode2(struct tdecoder2 *dec, int len, int iter,
+			   const struct lte_turbo_block *blk)
+{
+	int i;
+	struct vtrellis2 *trellis = dec->trellis;
+
+	load_pair(dec, len, 0, &blk[0]);
+	load_pair(dec, len, 1, &blk[1]);
+
+	memset(dec->bwsums, 0, sizeof(dec->bwsums));
+	memset(trellis[0].lvals, 0, (len + 3) * sizeof(trellis[0].lvals[0]));
+	memset(trellis[1].lvals, 0, (len + 3) * sizeof(trellis[1].lvals[0]));
+
+	for (i = 0; i < iter; i++) {
+		turbo_iterate2(dec, &trellis[0], len + 3);
+		turbo_interleave_lval2(len,
+				       trellis[0].lvals,
+				       trellis[1].lvals);
+
+		turbo_iterate2(dec, &trellis[1], len + 3);
+		turbo_deinterleave_lval2(len,
+					 trellis[1].lvals,
+					 trellis[0].lvals);
+	}
+}
+#endif /* HAVE_AVX2 */
+
+/*
+ * Single block of multi-block decoding
+ *
+ * Blocks that do not fill a paired or batch group are decoded with default
+ * options, so that output does not depend on the position of a block or on
+ * the options of the calling decoder.
+ */
+static int decode_plain(struct tdecoder *dec, int len, int iter,
+			const struct lte_turbo_block *blk)
+{
+	if (!dec->plain) {
+		dec->plain = alloc_tdec();
+		if (!dec->plain)
+			return -ENOMEM;
+	}
+
+	return lte_turbo_decode(dec->plain, len, iter, blk->output,
+				blk->d0, blk->d1, blk->d2);
+}
+
+/*
+ * Decode two code blocks of equal length
+ *
+ * With AVX2 both blocks are decoded together in the two 128-bit lanes of
+ * each register. Otherwise fall back to decoding the blocks one at a time.
+ */
+API_EXPORT
+int lte_turbo_decode2(struct tdecoder *dec, int len, int iter,
+		      struct lte_turbo_block *blk)
+{
+	int i, n;
+
+	if ((len < TURBO_MIN_K) || len > TURBO_MAX_K)
+		return -EINVAL;
+
+#ifdef HAVE_AVX2
+	int16_t lvals[len];
+
+	if (!dec->pair) {
+		dec->pair = alloc_tdec2();
+		if (!dec->pair)
+			return -ENOMEM;
+	}
+
+	_turbo_decode2(dec->pair, len, iter, blk);
+
+	for (n = 0; n < 2; n++) {
+		for (i = 0; i < len; i++)
+			lvals[i] = dec->pair->trellis[0].lvals[i][n];
+		pack_lvals(lvals, len, blk[n].output);
+	}
+#else
+	for (n = 0; n < 2; n++) {
+		i = decode_plain(dec, len, iter, &blk[n]);
+		if (i < 0)
+			return i;
+	}
+#endif
+	return iter;
+}
+
+/*
+ * Decode a batch of code blocks of equal length
+ *
+ * Blocks are decoded in groups with one code block per SIMD lane using the
+ * transposed batch recursions.
+ */
+API_EXPORT
+int lte_turbo_decode_batch(struct tdecoder *dec, int n, int len, int iter,
+			   struct lte_turbo_block *blk)
+{
+	int i, j, cnt, rc, width = tbatch_width();
+
+	if ((len < TURBO_MIN_K) || len > TURBO_MAX_K || n < 0)
+		return -EINVAL;
+
+	int16_t lvals[len];
+
+	if (!width) {
+		for (i = 0; i < n; i++) {
+			rc = decode_plain(dec, len, iter, &blk[i]);
+			if (rc < 0)
+				return rc;
+		}
+		return 0;
+	}
+
+	if (!dec->batch) {
+		dec->batch = alloc_tbatch();
+		if (!dec->batch)
+			return -ENOMEM;
+	}
+
+	for (i = 0; i < n; i += width) {
+		cnt = n - i < width ? n - i : width;
+
+		/*
+		 * Groups that fill no more than half of a 256-bit batch are
+		 * faster with the paired decoder. Larger groups that fill no
+		 * more than half of an AVX-512 batch run at 256-bit width.
+		 */
+		if (2 * cnt <= (width < 16 ? width : 16)) {
+			for (j = 0; j < cnt - 1; j += 2) {
+				rc = lte_turbo_decode2(dec, len, iter,
+						       &blk[i + j]);
+				if (rc < 0)
+					return rc;
+			}
+			if (j < cnt) {
+				rc = decode_plain(dec, len, iter, &blk[i + j]);
+				if (rc < 0)
+					return rc;
+			}
+			break;
+		}
+
+		rc = tbatch_decode(dec->batch, len, iter, &blk[i], cnt);
+		if (rc < 0)
+			return rc;
+
+		for (j = 0; j < cnt; j++) {
+			tbatch_lvals(dec->batch, len, j, lvals);
+			pack_lvals(lvals, len, blk[i + j].output);
+		}
+	}
 
 	return 0;
 }
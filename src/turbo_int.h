@@ -1,6 +1,12 @@
 #ifndef _TURBO_INTERLEAVE_
 #define _TURBO_INTERLEAVE_
 
+#define NUM_TRELLIS_STATES	8
+#define MAX_TRELLIS_LEN		(TURBO_MAX_K + 3)
+
+/* Initialization value for forward and backward sums */
+#define SUM_INIT		16000
+
 /* Interleaver for initialization - 8-bits */
 int turbo_interleave(int k, const uint8_t *input, uint8_t *output);
 
@@ -11,4 +17,62 @@ void turbo_unterm(int len, uint8_t *d0, uint8_t *d1, uint8_t *d2, uint8_t *d0p);
 int turbo_interleave_lval(int k, const int16_t *in, int16_t *out);
 int turbo_deinterleave_lval(int k, const int16_t *in, int16_t *out);
 
+/* Interleaver for L-value pairs - 2 x 16-bits */
+int turbo_interleave_lval2(int k, const int16_t (*in)[2], int16_t (*out)[2]);
+int turbo_deinterleave_lval2(int k, const int16_t (*in)[2], int16_t (*out)[2]);
+
+/* Interleaver map for direct interleaved access */
+const uint16_t *turbo_interleave_map(int k);
+
+/* Interleaver for a segment of L-values - 16-bits */
+int turbo_interleave_lval_seg(int k, int start, int n,
+			      const int16_t *in, int16_t *out);
+int turbo_deinterleave_lval_seg(int k, int start, int n,
+				const int16_t *in, int16_t *out);
+
+/* Interleaver coefficients f1 and f2 */
+int turbo_interleave_qpp(int k, int *f1, int *f2);
+
+/* Transposed multiple code block decoder */
+struct tbatch;
+struct lte_turbo_block;
+
+int tbatch_width();
+struct tbatch *alloc_tbatch();
+void free_tbatch(struct tbatch *batch);
+int tbatch_decode(struct tbatch *batch, int len, int iter,
+		  const struct lte_turbo_block *blk, int n);
+void tbatch_lvals(const struct tbatch *batch, int len, int n, int16_t *lvals);
+
+#ifdef HAVE_AVX512_BW
+/* 256-bit batch decoder for groups that fill half of an AVX-512 batch */
+struct tbatch256;
+
+struct tbatch256 *alloc_tbatch256();
+void free_tbatch256(struct tbatch256 *batch);
+int tbatch256_decode(struct tbatch256 *batch, int len, int iter,
+		     const struct lte_turbo_block *blk, int n);
+void tbatch256_lvals(const struct tbatch256 *batch, int len, int n,
+		     int16_t *lvals);
+#endif
+
+/* Single code block decoder */
+struct tdecoder;
+struct lte_turbo_tti_block;
+
+int tdec_decode_block(struct tdecoder *dec, int iter,
+		      struct lte_turbo_tti_block *blk);
+
+/* CRC remainder of packed bits - 24-bits */
+uint32_t turbo_crc24(int type, const uint8_t *in, int len);
+
+/* Worker threads */
+struct tpool;
+
+struct tpool *alloc_tpool(int num);
+void free_tpool(struct tpool *pool);
+int tpool_size(const struct tpool *pool);
+void tpool_run(struct tpool *pool, void (*func)(void *arg, int idx), void *arg);
+void tpool_barrier(struct tpool *pool);
+
 #endif /* _TURBO_INTERLEAVE_ */
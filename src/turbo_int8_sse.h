@@ -0,0 +1,183 @@
+/*
+ * LTE Max-Log-MAP turbo decoder - SSE 8-bit recursions
+ *
+ * Copyright (C) 2015 Ettus Research LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Tom Tsou <tom.tsou@ettus.com>
+ */
+
+/*
+ * 8-bit recursions
+ *
+ * Metrics are held as saturating 8-bit values, which places two sets of 8
+ * trellis states in a single register. The lower and upper halves of each
+ * register carry two independent segments of the same trellis. Each step
+ * processes one trellis stage of both segments.
+ *
+ * Saturation only applies to unlikely paths because metrics are normalized
+ * to the maximum state after every stage. Normalizing to state 0 instead
+ * would clip the surviving path once the decoder converges.
+ *
+ * Inputs for a step are passed as packed bytes: systematic values of both
+ * segments in bytes 0-1, parity values in bytes 2-3.
+ */
+#ifdef HAVE_SSE3
+#include <stdint.h>
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+#if defined(HAVE_SSE4_1) || defined(HAVE_SSE41)
+#include <smmintrin.h>
+#define MAX8(A,B)	_mm_max_epi8(A, B)
+#else
+#define MAX8(A,B) \
+	_mm_xor_si128(_mm_max_epu8(_mm_xor_si128(A, _mm_set1_epi8(-128)), \
+				   _mm_xor_si128(B, _mm_set1_epi8(-128))), \
+		      _mm_set1_epi8(-128))
+#endif
+
+/* Input broadcast - systematic and parity values of each segment */
+#define I8_SYSTEM_MASK	1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0
+#define I8_PARITY_MASK	3, 3, 3, 3, 3, 3, 3, 3, 2, 2, 2, 2, 2, 2, 2, 2
+
+/* Forward predecessor states, see FW_SHUFFLE_MASK0/1 */
+#define I8_FW_MASK0	14, 12, 10, 8, 14, 12, 10, 8, 6, 4, 2, 0, 6, 4, 2, 0
+#define I8_FW_MASK1	15, 13, 11, 9, 15, 13, 11, 9, 7, 5, 3, 1, 7, 5, 3, 1
+
+/* Backward successor states and interleaved branch metrics */
+#define I8_BW_MASK0	11, 11, 10, 10, 9, 9, 8, 8, 3, 3, 2, 2, 1, 1, 0, 0
+#define I8_BW_MASK1	15, 15, 14, 14, 13, 13, 12, 12, 7, 7, 6, 6, 5, 5, 4, 4
+#define I8_BM_MASK	15, 11, 14, 10, 13, 9, 12, 8, 7, 3, 6, 2, 5, 1, 4, 0
+
+/* L-value state ordering, see LV_BW_SHUFFLE_MASK0/1 */
+#define I8_LV_MASK0	11, 15, 14, 10, 9, 13, 12, 8, 3, 7, 6, 2, 1, 5, 4, 0
+#define I8_LV_MASK1	15, 11, 10, 14, 13, 9, 8, 12, 7, 3, 2, 6, 5, 1, 0, 4
+
+/* Byte swaps for horizontal maximums within each segment */
+#define I8_SWAP2_MASK	13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2
+#define I8_SWAP1_MASK	14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1
+
+/* Maximum of each segment broadcast to all states of the segment */
+static inline __m128i i8_hmax(__m128i m0)
+{
+	__m128i m1;
+
+	m1 = _mm_shuffle_epi32(m0, _MM_SHUFFLE(2, 3, 0, 1));
+	m0 = MAX8(m0, m1);
+	m1 = _mm_shuffle_epi8(m0, _mm_set_epi8(I8_SWAP2_MASK));
+	m0 = MAX8(m0, m1);
+	m1 = _mm_shuffle_epi8(m0, _mm_set_epi8(I8_SWAP1_MASK));
+
+	return MAX8(m0, m1);
+}
+
+/*
+ * Forward recursion
+ *
+ * A-priori values in bytes 0-1 of 'le' are added to the systematic inputs.
+ * Branch metrics are stored for upper and lower paths of both segments.
+ */
+static inline void gen_fw_metrics8(int8_t *bm, uint32_t xz, uint16_t le,
+				   const int8_t *sums_p, int8_t *sums_c)
+{
+	__m128i m0, m1, m2, m3, m4;
+
+	m0 = _mm_adds_epi8(_mm_cvtsi32_si128(xz), _mm_cvtsi32_si128(le));
+
+	/* Branch metrics */
+	m1 = _mm_shuffle_epi8(m0, _mm_set_epi8(I8_SYSTEM_MASK));
+	m2 = _mm_shuffle_epi8(m0, _mm_set_epi8(I8_PARITY_MASK));
+	m1 = _mm_sign_epi8(m1, _mm_set_epi8(LTE_SYSTEM_FW_SHUFFLE,
+					    LTE_SYSTEM_FW_SHUFFLE));
+	m2 = _mm_sign_epi8(m2, _mm_set_epi8(LTE_PARITY_FW_SHUFFLE,
+					    LTE_PARITY_FW_SHUFFLE));
+	m1 = _mm_adds_epi8(m1, m2);
+	m2 = _mm_subs_epi8(_mm_setzero_si128(), m1);
+
+	_mm_store_si128((__m128i *) bm, m1);
+
+	/* Forward metrics */
+	m0 = _mm_load_si128((__m128i *) sums_p);
+	m3 = _mm_shuffle_epi8(m0, _mm_set_epi8(I8_FW_MASK0));
+	m4 = _mm_shuffle_epi8(m0, _mm_set_epi8(I8_FW_MASK1));
+	m3 = _mm_adds_epi8(m3, m1);
+	m4 = _mm_adds_epi8(m4, m2);
+
+	m0 = MAX8(m3, m4);
+	m0 = _mm_subs_epi8(m0, i8_hmax(m0));
+
+	_mm_store_si128((__m128i *) sums_c, m0);
+}
+
+/*
+ * Backward recursion
+ *
+ * Lower path branch metrics are the negated upper path metrics, so both are
+ * taken from the stored upper path metrics with a single shuffle. Parity
+ * values in bytes 2-3 of 'xz' are used for the L-values, which are returned
+ * for both segments in 'lv'.
+ */
+static inline void gen_bw_metrics8(const int8_t *bm, uint32_t xz,
+				   const int8_t *fw, int8_t *bw, int8_t *lv)
+{
+	__m128i m0, m1, m2, m3, m4, m5, m6;
+
+	m0 = _mm_load_si128((__m128i *) bw);
+	m1 = _mm_load_si128((__m128i *) bm);
+	m2 = _mm_load_si128((__m128i *) fw);
+
+	/* Backward metrics */
+	m1 = _mm_shuffle_epi8(m1, _mm_set_epi8(I8_BM_MASK));
+	m3 = _mm_shuffle_epi8(m0, _mm_set_epi8(I8_BW_MASK0));
+	m4 = _mm_shuffle_epi8(m0, _mm_set_epi8(I8_BW_MASK1));
+	m3 = _mm_adds_epi8(m3, m1);
+	m4 = _mm_subs_epi8(m4, m1);
+
+	m1 = MAX8(m3, m4);
+	m1 = _mm_subs_epi8(m1, i8_hmax(m1));
+	_mm_store_si128((__m128i *) bw, m1);
+
+	/* L-values */
+	m5 = _mm_shuffle_epi8(_mm_cvtsi32_si128(xz),
+			      _mm_set_epi8(I8_PARITY_MASK));
+	m5 = _mm_sign_epi8(m5, _mm_set_epi8(LTE_PARITY_BW_SHUFFLE,
+					    LTE_PARITY_BW_SHUFFLE));
+
+	m3 = _mm_shuffle_epi8(m0, _mm_set_epi8(I8_LV_MASK0));
+	m4 = _mm_shuffle_epi8(m0, _mm_set_epi8(I8_LV_MASK1));
+	m6 = _mm_adds_epi8(m2, m5);
+	m2 = _mm_subs_epi8(m2, m5);
+	m3 = _mm_adds_epi8(m6, m3);
+	m4 = _mm_adds_epi8(m2, m4);
+
+	m0 = _mm_subs_epi8(i8_hmax(m4), i8_hmax(m3));
+
+	lv[0] = _mm_cvtsi128_si32(m0);
+	lv[1] = _mm_extract_epi16(m0, 4);
+}
+#else
+static inline void gen_fw_metrics8(int8_t *bm, uint32_t xz, uint16_t le,
+				   const int8_t *sums_p, int8_t *sums_c)
+{
+}
+
+static inline void gen_bw_metrics8(const int8_t *bm, uint32_t xz,
+				   const int8_t *fw, int8_t *bw, int8_t *lv)
+{
+	lv[0] = 0;
+	lv[1] = 0;
+}
+#endif /* HAVE_SSE3 */
@@ -0,0 +1,169 @@
+/*
+ * LTE code block segmentation
+ *
+ * Copyright (C) 2015 Ettus Research LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Tom Tsou <tom.tsou@ettus.com>
+ */
+
+
+#include <string.h>
+#include <errno.h>
+#include "turbofec/crc.h"
+#include "turbofec/segment.h"
+#include "turbofec/turbo.h"
+
+#define API_EXPORT	__attribute__((__visibility__("default")))
+
+/* Transport and code block CRC lengths */
+#define TB_CRC_LEN		24
+#define CB_CRC_LEN		24
+
+/*
+ * Smallest interleaver size of at least 'n'
+ *
+ * 3GPP TS 36.212 Release 8, Table 5.1.3-3. Sizes are spaced by 8, 16, 32
+ * and 64 over four ranges.
+ */
+static int round_k(int n)
+{
+	if (n <= TURBO_MIN_K)
+		return TURBO_MIN_K;
+	if (n <= 512)
+		return (n + 7) & ~7;
+	if (n <= 1024)
+		return (n + 15) & ~15;
+	if (n <= 2048)
+		return (n + 31) & ~31;
+
+	return (n + 63) & ~63;
+}
+
+/* Largest interleaver size below 'k' */
+static int prev_k(int k)
+{
+	if (k <= 512)
+		return k - 8;
+	if (k <= 1024)
+		return k - 16;
+	if (k <= 2048)
+		return k - 32;
+
+	return k - 64;
+}
+
+API_EXPORT
+int lte_segment_init(struct lte_segment *seg, int len)
+{
+	int b, l = 0, c = 1;
+
+	if ((len < 0) || (len % 8))
+		return -EINVAL;
+
+	b = len + TB_CRC_LEN;
+
+	if (b > TURBO_MAX_K) {
+		l = CB_CRC_LEN;
+		c = (b + TURBO_MAX_K - l - 1) / (TURBO_MAX_K - l);
+		b += c * l;
+	}
+
+	seg->len = len;
+	seg->num = c;
+	seg->k_plus = round_k((b + c - 1) / c);
+
+	if (c == 1) {
+		seg->num_plus = 1;
+		seg->num_minus = 0;
+		seg->k_minus = 0;
+	} else {
+		seg->k_minus = prev_k(seg->k_plus);
+		seg->num_minus = (c * seg->k_plus - b) /
+				 (seg->k_plus - seg->k_minus);
+		seg->num_plus = c - seg->num_minus;
+	}
+
+	seg->filler = seg->num_plus * seg->k_plus +
+		      seg->num_minus * seg->k_minus - b;
+
+	return 0;
+}
+
+API_EXPORT
+int lte_segment_len(const struct lte_segment *seg, int r)
+{
+	if ((r < 0) || (r >= seg->num))
+		return -EINVAL;
+
+	return r < seg->num_minus ? seg->k_minus : seg->k_plus;
+}
+
+/*
+ * Number of transport block bytes carried by code block 'r', which start
+ * after 'skip' bytes of filler bits
+ */
+static int cb_data(const struct lte_segment *seg, int r, int *skip)
+{
+	int n = lte_segment_len(seg, r) / 8;
+
+	*skip = r ? 0 : seg->filler / 8;
+	if (seg->num > 1)
+		n -= CB_CRC_LEN / 8;
+
+	return n - *skip;
+}
+
+API_EXPORT
+int lte_segment(const struct lte_segment *seg, const uint8_t *in,
+		uint8_t *const *cb)
+{
+	int r, n, skip, pos = 0;
+	uint8_t tb[seg->len / 8 + TB_CRC_LEN / 8];
+
+	memcpy(tb, in, seg->len / 8);
+	lte_crc_attach(LTE_CRC24A, tb, seg->len / 8);
+
+	for (r = 0; r < seg->num; r++) {
+		n = cb_data(seg, r, &skip);
+
+		memset(cb[r], 0, skip);
+		memcpy(&cb[r][skip], &tb[pos], n);
+		pos += n;
+
+		if (seg->num > 1)
+			lte_crc_attach(LTE_CRC24B, cb[r], skip + n);
+	}
+
+	return seg->num;
+}
+
+API_EXPORT
+int lte_desegment(const struct lte_segment *seg, const uint8_t *const *cb,
+		  uint8_t *out)
+{
+	int r, n, skip, pos = 0;
+	uint8_t tb[seg->len / 8 + TB_CRC_LEN / 8];
+
+	for (r = 0; r < seg->num; r++) {
+		n = cb_data(seg, r, &skip);
+		memcpy(&tb[pos], &cb[r][skip], n);
+		pos += n;
+	}
+
+	memcpy(out, tb, seg->len / 8);
+
+	return lte_crc_check(LTE_CRC24A, tb, pos);
+}
@@ -212,6 +212,553 @@ static inline int16_t gen_bw_metrics(int16_t *bm, const int8_t z,
 	/* Return cast should truncate upper 16-bits */
 	return _mm_cvtsi128_si32(m13);
 }
+
+/*
+ * Max-Log-MAP Backward Training Recursion
+ *
+ * Backward metric update without L-value output for acquiring the backward
+ * metrics at a sliding window boundary. Branch metrics are generated from
+ * the inputs and metrics are normalized to state 0.
+ */
+static inline void gen_bw_train(int8_t x, int8_t z, int16_t le, int16_t *bw)
+{
+	__m128i m0, m1, m2, m3, m4, m5;
+
+	m0 = _mm_sign_epi16(_mm_set1_epi16(x),
+			    _mm_set_epi16(LTE_SYSTEM_FW_SHUFFLE));
+	m1 = _mm_sign_epi16(_mm_set1_epi16(z),
+			    _mm_set_epi16(LTE_PARITY_FW_SHUFFLE));
+	m2 = _mm_sign_epi16(_mm_set1_epi16(le),
+			    _mm_set_epi16(LTE_SYSTEM_FW_SHUFFLE));
+	m2 = _mm_srai_epi16(m2, 1);
+
+	m0 = _mm_adds_epi16(_mm_adds_epi16(m0, m1), m2);
+	m1 = _mm_subs_epi16(_mm_setzero_si128(), m0);
+	m2 = _mm_unpacklo_epi16(m0, m1);
+
+	m3 = _mm_load_si128((__m128i *) bw);
+	m4 = _mm_unpacklo_epi16(m3, m3);
+	m5 = _mm_unpackhi_epi16(m3, m3);
+	m4 = _mm_adds_epi16(m4, m2);
+	m5 = _mm_subs_epi16(m5, m2);
+
+	m0 = _mm_max_epi16(m4, m5);
+	m1 = _mm_shufflelo_epi16(m0, _MM_SHUFFLE(0, 0, 0, 0));
+	m1 = _mm_unpacklo_epi64(m1, m1);
+	m0 = _mm_subs_epi16(m0, m1);
+
+	_mm_store_si128((__m128i *) bw, m0);
+}
+
+/*
+ * Modulo Normalization
+ *
+ * Path metrics wrap around in two's complement arithmetic instead of being
+ * normalized at every step. As long as the metric spread between states
+ * stays below half the 16-bit range, wrapped differences equal the true
+ * differences and the larger of two metrics is b + max(a - b, 0). Metrics
+ * are brought back to the usual normalized form only where they leave the
+ * recursions. The spread is bounded by the clipped a-priori values and by
+ * flooring the initial metrics.
+ */
+#define MOD_MAX_LE	2048
+#define MOD_MAX_SPREAD	8192
+
+/*
+ * Larger of a + g and b - g, evaluated as b + g + max(a - b, -2g) so that
+ * terms of 'g' are added outside of the dependency chain through 'a' and 'b'
+ */
+static inline __m128i acs_mod(__m128i a, __m128i b, __m128i g)
+{
+	__m128i m0, m1;
+
+	m0 = _mm_sub_epi16(_mm_setzero_si128(), _mm_add_epi16(g, g));
+	m1 = _mm_add_epi16(b, g);
+	m0 = _mm_max_epi16(_mm_sub_epi16(a, b), m0);
+
+	return _mm_add_epi16(m0, m1);
+}
+
+/* Metrics of 'sums' relative to the maximum, floored to the largest spread */
+static inline void gen_mod_init(int16_t *sums)
+{
+	__m128i m0, m1, m2;
+
+	m0 = _mm_load_si128((__m128i *) sums);
+	MAXPOS(m0, m1, m2);
+	m2 = _mm_shufflelo_epi16(m2, _MM_SHUFFLE(0, 0, 0, 0));
+	m2 = _mm_unpacklo_epi64(m2, m2);
+	m0 = _mm_subs_epi16(m0, m2);
+	m0 = _mm_max_epi16(m0, _mm_set1_epi16(-MOD_MAX_SPREAD));
+
+	_mm_store_si128((__m128i *) sums, m0);
+}
+
+/* Wrapped metrics of 'sums' normalized to state 0 */
+static inline void gen_mod_norm(int16_t *sums)
+{
+	__m128i m0, m1;
+
+	m0 = _mm_load_si128((__m128i *) sums);
+	m1 = _mm_shufflelo_epi16(m0, _MM_SHUFFLE(0, 0, 0, 0));
+	m1 = _mm_unpacklo_epi64(m1, m1);
+	m0 = _mm_sub_epi16(m0, m1);
+
+	_mm_store_si128((__m128i *) sums, m0);
+}
+
+/*
+ * Modulo Forward Recursion
+ *
+ * Forward recursion of gen_fw_metrics() without normalization. A-priori
+ * values must be clipped to MOD_MAX_LE.
+ */
+static inline void gen_fw_metrics_mod(int16_t *bm, int8_t x, int8_t z,
+				      const int16_t *sums_p, int16_t *sums_c,
+				      int16_t le)
+{
+	__m128i m0, m1, m2, m3;
+
+	m0 = _mm_sign_epi16(_mm_set1_epi16(x),
+			    _mm_set_epi16(LTE_SYSTEM_FW_SHUFFLE));
+	m1 = _mm_sign_epi16(_mm_set1_epi16(z),
+			    _mm_set_epi16(LTE_PARITY_FW_SHUFFLE));
+	m2 = _mm_sign_epi16(_mm_set1_epi16(le),
+			    _mm_set_epi16(LTE_SYSTEM_FW_SHUFFLE));
+	m2 = _mm_srai_epi16(m2, 1);
+
+	/* Branch metrics */
+	m0 = _mm_add_epi16(_mm_add_epi16(m0, m1), m2);
+	m1 = _mm_sub_epi16(_mm_setzero_si128(), m0);
+	_mm_store_si128((__m128i *) bm, _mm_unpacklo_epi16(m0, m1));
+
+	/* Forward metrics */
+	m3 = _mm_load_si128((__m128i *) sums_p);
+	m2 = _mm_shuffle_epi8(m3, _mm_set_epi8(FW_SHUFFLE_MASK0));
+	m3 = _mm_shuffle_epi8(m3, _mm_set_epi8(FW_SHUFFLE_MASK1));
+
+	_mm_store_si128((__m128i *) sums_c, acs_mod(m2, m3, m0));
+}
+
+/*
+ * Modulo Backward Recursion
+ *
+ * Backward recursion of gen_bw_metrics() without normalization. Sums for
+ * the L-value are taken relative to one of them, which restores the true
+ * differences before the maximums.
+ */
+static inline int16_t gen_bw_metrics_mod(const int16_t *bm, const int8_t z,
+					 const int16_t *fw, int16_t *bw)
+{
+	__m128i m0, m1, m2, m3, m4, m5, m6;
+
+	m0 = _mm_load_si128((__m128i *) bw);
+	m1 = _mm_load_si128((__m128i *) bm);
+	m2 = _mm_load_si128((__m128i *) fw);
+
+	/* Backward metrics */
+	m3 = _mm_unpacklo_epi16(m0, m0);
+	m4 = _mm_unpackhi_epi16(m0, m0);
+	_mm_store_si128((__m128i *) bw, acs_mod(m3, m4, m1));
+
+	/*
+	 * L-values - parity is widened to 32 bits before the broadcast. A
+	 * 16-bit load merges into the register of the previous L-value and
+	 * chains the otherwise independent L-value steps.
+	 */
+	m1 = _mm_shufflelo_epi16(_mm_cvtsi32_si128(z), _MM_SHUFFLE(0, 0, 0, 0));
+	m1 = _mm_sign_epi16(_mm_unpacklo_epi64(m1, m1),
+			    _mm_set_epi16(LTE_PARITY_BW_SHUFFLE));
+	m3 = _mm_shuffle_epi8(m0, _mm_set_epi8(LV_BW_SHUFFLE_MASK0));
+	m4 = _mm_shuffle_epi8(m0, _mm_set_epi8(LV_BW_SHUFFLE_MASK1));
+	m3 = _mm_add_epi16(_mm_add_epi16(m2, m1), m3);
+	m4 = _mm_add_epi16(_mm_sub_epi16(m2, m1), m4);
+
+	m5 = _mm_shufflelo_epi16(m3, _MM_SHUFFLE(0, 0, 0, 0));
+	m5 = _mm_unpacklo_epi64(m5, m5);
+	m3 = _mm_sub_epi16(m3, m5);
+	m4 = _mm_sub_epi16(m4, m5);
+
+	MAXPOS(m3, m0, m5);
+	MAXPOS(m4, m0, m6);
+
+	return _mm_cvtsi128_si32(_mm_sub_epi16(m6, m5));
+}
+
+/*
+ * Log-MAP Correction
+ *
+ * The Jacobian logarithm max*(a, b) = max(a, b) + log(1 + exp(-|a - b|))
+ * replaces the maximum of the max-log-MAP recursions. The correction term
+ * is looked up from a 16 entry byte table indexed by the metric difference
+ * shifted right by 'shift'. The table is held in reverse order and indexed
+ * by the saturated distance from the last entry, which clips large
+ * differences to entry 0. Entry 0 is zero, which also clears the upper byte
+ * of each 16-bit lookup result.
+ */
+static inline __m128i max_star(__m128i a, __m128i b, __m128i lut, __m128i shift)
+{
+	__m128i m0;
+
+	m0 = _mm_abs_epi16(_mm_subs_epi16(a, b));
+	m0 = _mm_subs_epu16(_mm_set1_epi16(15), _mm_srl_epi16(m0, shift));
+	m0 = _mm_shuffle_epi8(lut, m0);
+
+	return _mm_adds_epi16(_mm_max_epi16(a, b), m0);
+}
+
+/*
+ * Log-MAP Forward Recursion
+ *
+ * Forward recursion of gen_fw_metrics() with the max* operation in place of
+ * the maximum over predecessor states.
+ */
+static inline int16_t gen_fw_metrics_lm(int16_t *bm, int8_t x, int8_t z,
+					int16_t *sums_p, int16_t *sums_c,
+					int16_t le, const int8_t *lut,
+					int shift)
+{
+	__m128i m0, m1, m2, m3, m4, m5;
+
+	m0 = _mm_sign_epi16(_mm_set1_epi16(x),
+			    _mm_set_epi16(LTE_SYSTEM_FW_SHUFFLE));
+	m1 = _mm_sign_epi16(_mm_set1_epi16(z),
+			    _mm_set_epi16(LTE_PARITY_FW_SHUFFLE));
+	m2 = _mm_sign_epi16(_mm_set1_epi16(le),
+			    _mm_set_epi16(LTE_SYSTEM_FW_SHUFFLE));
+	m2 = _mm_srai_epi16(m2, 1);
+
+	/* Branch metrics */
+	m0 = _mm_adds_epi16(_mm_adds_epi16(m0, m1), m2);
+	m1 = _mm_subs_epi16(_mm_setzero_si128(), m0);
+	_mm_store_si128((__m128i *) bm, _mm_unpacklo_epi16(m0, m1));
+
+	/* Forward metrics */
+	m2 = _mm_load_si128((__m128i *) sums_p);
+	m3 = _mm_shuffle_epi8(m2, _mm_set_epi8(FW_SHUFFLE_MASK0));
+	m4 = _mm_shuffle_epi8(m2, _mm_set_epi8(FW_SHUFFLE_MASK1));
+	m3 = _mm_adds_epi16(m3, m0);
+	m4 = _mm_adds_epi16(m4, m1);
+
+	m5 = _mm_loadu_si128((__m128i *) lut);
+	m0 = max_star(m3, m4, m5, _mm_cvtsi32_si128(shift));
+	m1 = _mm_shufflelo_epi16(m0, _MM_SHUFFLE(0, 0, 0, 0));
+	m1 = _mm_unpacklo_epi64(m1, m1);
+	m0 = _mm_subs_epi16(m0, m1);
+
+	_mm_store_si128((__m128i *) sums_c, m0);
+
+	return _mm_cvtsi128_si32(m1);
+}
+
+/*
+ * Log-MAP Backward Recursion
+ *
+ * Backward recursion of gen_bw_metrics() with the max* operation. L-value
+ * sums of the 0 and 1 transitions are reduced over all states by a pairwise
+ * max* tree, with the two sets held in the lower and upper register halves.
+ */
+static inline int16_t gen_bw_metrics_lm(int16_t *bm, const int8_t z,
+					int16_t *fw, int16_t *bw, int16_t norm,
+					const int8_t *lut, int shift)
+{
+	__m128i m0, m1, m2, m3, m4, m5, m6, m7;
+
+	m6 = _mm_loadu_si128((__m128i *) lut);
+	m7 = _mm_cvtsi32_si128(shift);
+
+	/* Backward metrics */
+	m0 = _mm_load_si128((__m128i *) bw);
+	m1 = _mm_load_si128((__m128i *) bm);
+	m4 = _mm_unpacklo_epi16(m0, m0);
+	m5 = _mm_unpackhi_epi16(m0, m0);
+	m4 = _mm_adds_epi16(m4, m1);
+	m5 = _mm_subs_epi16(m5, m1);
+
+	m1 = max_star(m4, m5, m6, m7);
+	m1 = _mm_subs_epi16(m1, _mm_set1_epi16(norm));
+	_mm_store_si128((__m128i *) bw, m1);
+
+	/* L-values */
+	m1 = _mm_sign_epi16(_mm_set1_epi16(z),
+			    _mm_set_epi16(LTE_PARITY_BW_SHUFFLE));
+	m2 = _mm_load_si128((__m128i *) fw);
+	m3 = _mm_subs_epi16(m2, m1);
+	m2 = _mm_adds_epi16(m2, m1);
+	m2 = _mm_adds_epi16(m2, _mm_shuffle_epi8(m0,
+				_mm_set_epi8(LV_BW_SHUFFLE_MASK0)));
+	m3 = _mm_adds_epi16(m3, _mm_shuffle_epi8(m0,
+				_mm_set_epi8(LV_BW_SHUFFLE_MASK1)));
+
+	/* Pairwise reduction */
+	m4 = _mm_unpacklo_epi64(m2, m3);
+	m5 = _mm_unpackhi_epi64(m2, m3);
+	m0 = max_star(m4, m5, m6, m7);
+	m1 = _mm_shuffle_epi32(m0, _MM_SHUFFLE(2, 3, 0, 1));
+	m0 = max_star(m0, m1, m6, m7);
+	m1 = _mm_shufflelo_epi16(m0, _MM_SHUFFLE(2, 3, 0, 1));
+	m1 = _mm_shufflehi_epi16(m1, _MM_SHUFFLE(2, 3, 0, 1));
+	m0 = max_star(m0, m1, m6, m7);
+
+	m1 = _mm_shuffle_epi32(m0, _MM_SHUFFLE(1, 0, 3, 2));
+	m0 = _mm_sub_epi16(m1, m0);
+
+	/* Return cast should truncate upper 16-bits */
+	return _mm_cvtsi128_si32(m0);
+}
+
+/*
+ * Radix-4 shuffle masks
+ *
+ * Two trellis stages are merged so that each state at step i + 2 has four
+ * predecessors at step i. States j with (j % 2) == 0 are entered from states
+ * 0-3 and odd states are entered from states 4-7. Predecessor masks select
+ * state k and k + 4 for even and odd states respectively.
+ *
+ * For the backward direction, each state p has four successors at step
+ * i + 2 given by (p / 4) + 2 * a1 + 4 * a2 where a1 and a2 are the feedback
+ * bits entering the shift register.
+ */
+#define R4_FW_PRED_MASK0 9, 8, 1, 0, 9, 8, 1, 0, 9, 8, 1, 0, 9, 8, 1, 0
+#define R4_FW_PRED_MASK1 11, 10, 3, 2, 11, 10, 3, 2, 11, 10, 3, 2, 11, 10, 3, 2
+#define R4_FW_PRED_MASK2 13, 12, 5, 4, 13, 12, 5, 4, 13, 12, 5, 4, 13, 12, 5, 4
+#define R4_FW_PRED_MASK3 15, 14, 7, 6, 15, 14, 7, 6, 15, 14, 7, 6, 15, 14, 7, 6
+
+#define R4_BW_SUCC_MASK0 3, 2, 3, 2, 3, 2, 3, 2, 1, 0, 1, 0, 1, 0, 1, 0
+#define R4_BW_SUCC_MASK1 7, 6, 7, 6, 7, 6, 7, 6, 5, 4, 5, 4, 5, 4, 5, 4
+#define R4_BW_SUCC_MASK2 11, 10, 11, 10, 11, 10, 11, 10, 9, 8, 9, 8, 9, 8, 9, 8
+#define R4_BW_SUCC_MASK3 15, 14, 15, 14, 15, 14, 15, 14, 13, 12, 13, 12, 13, 12, 13, 12
+
+/* First stage branch metric signs in the backward direction */
+#define R4_BW_SIGN	-1, 1, -1, 1, -1, 1, -1, 1
+
+/* Broadcast the state 0 metric to all lanes */
+static inline __m128i r4_bcast0(__m128i m0)
+{
+#ifdef HAVE_AVX2
+	return _mm_broadcastw_epi16(m0);
+#else
+	m0 = _mm_unpacklo_epi16(m0, m0);
+	m0 = _mm_unpacklo_epi32(m0, m0);
+	return _mm_unpacklo_epi64(m0, m0);
+#endif
+}
+
+/*
+ * Shuffled branch metrics of a single stage
+ *
+ * Same values as the forward recursion. Systematic and a-priori terms share
+ * the same sign and are summed before broadcasting. The sum cannot exceed
+ * 16-bits, so results are identical.
+ */
+static inline __m128i r4_gen_bm(int8_t x, int8_t z, int16_t le)
+{
+	__m128i m0, m1;
+
+	m0 = _mm_sign_epi16(_mm_set1_epi16(x + (le >> 1)),
+			    _mm_set_epi16(LTE_SYSTEM_FW_SHUFFLE));
+	m1 = _mm_sign_epi16(_mm_set1_epi16(z),
+			    _mm_set_epi16(LTE_PARITY_FW_SHUFFLE));
+
+	return _mm_adds_epi16(m0, m1);
+}
+
+/*
+ * Radix-4 Max-Log-MAP Forward Recursion
+ *
+ * Advance the forward metrics two trellis stages. Branch metrics of both
+ * stages are combined into four metric vectors, one for each predecessor,
+ * which do not depend on the path metrics and stay off the loop carried
+ * dependency chain. Unshuffled branch metrics of both stages are stored for
+ * the backward recursion.
+ */
+static inline int16_t gen_fw_metrics_r4(int16_t *bm, const int8_t *x,
+					const int8_t *z, const int16_t *le,
+					int16_t *sums_p, int16_t *sums_c)
+{
+	__m128i m0, m1, m2, m3, m4, m5, m6, m7;
+
+	/* Branch metrics */
+	m0 = r4_gen_bm(x[0], z[0], le[0]);
+	m1 = r4_gen_bm(x[1], z[1], le[1]);
+	_mm_store_si128((__m128i *) &bm[0], m0);
+	_mm_store_si128((__m128i *) &bm[8], m1);
+
+	m2 = _mm_shuffle_epi8(m0, _mm_set_epi8(FW_SHUFFLE_MASK0));
+	m3 = _mm_shuffle_epi8(m0, _mm_set_epi8(FW_SHUFFLE_MASK1));
+
+	m4 = _mm_adds_epi16(m2, m1);
+	m5 = _mm_subs_epi16(m1, m2);
+	m6 = _mm_subs_epi16(m3, m1);
+	m7 = _mm_subs_epi16(_mm_setzero_si128(), _mm_adds_epi16(m3, m1));
+
+	/* Forward metrics */
+	m1 = _mm_load_si128((__m128i *) sums_p);
+
+	m0 = _mm_shuffle_epi8(m1, _mm_set_epi8(R4_FW_PRED_MASK0));
+	m2 = _mm_shuffle_epi8(m1, _mm_set_epi8(R4_FW_PRED_MASK1));
+	m3 = _mm_shuffle_epi8(m1, _mm_set_epi8(R4_FW_PRED_MASK2));
+	m1 = _mm_shuffle_epi8(m1, _mm_set_epi8(R4_FW_PRED_MASK3));
+
+	m0 = _mm_adds_epi16(m0, m4);
+	m2 = _mm_adds_epi16(m2, m5);
+	m3 = _mm_adds_epi16(m3, m6);
+	m1 = _mm_adds_epi16(m1, m7);
+
+	m0 = _mm_max_epi16(_mm_max_epi16(m0, m2), _mm_max_epi16(m3, m1));
+	m1 = r4_bcast0(m0);
+	m0 = _mm_subs_epi16(m0, m1);
+
+	_mm_store_si128((__m128i *) sums_c, m0);
+
+	return _mm_cvtsi128_si32(m1);
+}
+
+/* Single stage extrinsic L-value - same as the radix-2 recursion */
+static inline int16_t r4_gen_lval(__m128i fw, __m128i bw, int8_t z)
+{
+	__m128i m0, m1, m2, m3, m4;
+
+	m0 = _mm_sign_epi16(_mm_set1_epi16(z),
+			    _mm_set_epi16(LTE_PARITY_BW_SHUFFLE));
+	m1 = _mm_shuffle_epi8(bw, _mm_set_epi8(LV_BW_SHUFFLE_MASK0));
+	m2 = _mm_shuffle_epi8(bw, _mm_set_epi8(LV_BW_SHUFFLE_MASK1));
+
+	m1 = _mm_adds_epi16(_mm_adds_epi16(fw, m0), m1);
+	m2 = _mm_adds_epi16(_mm_subs_epi16(fw, m0), m2);
+
+	MAXPOS(m1, m0, m3);
+	MAXPOS(m2, m0, m4);
+
+	return _mm_cvtsi128_si32(_mm_sub_epi16(m4, m3));
+}
+
+/*
+ * L-values from stored metrics
+ *
+ * Single stage L-value from forward metrics of step i and backward metrics
+ * of step i + 1, for recursions that produce L-values in forward order.
+ */
+static inline int16_t gen_lval(const int16_t *fw, const int16_t *bw, int8_t z)
+{
+	return r4_gen_lval(_mm_load_si128((__m128i *) fw),
+			   _mm_load_si128((__m128i *) bw), z);
+}
+
+/*
+ * Radix-4 Max-Log-MAP Backward Recursion
+ *
+ * Reverse traversal of two trellis stages. Backward metrics of step i are
+ * generated directly from step i + 2 with branch metrics arranged into
+ * successor order off the dependency chain.
+ *
+ * Computing L-values over merged stages doubles the number of path metrics
+ * to compare. Instead, forward metrics of step i + 1 and backward metrics
+ * of step i + 1 are generated with single stage updates, which are also off
+ * the dependency chain, and L-values are produced with the radix-2 method.
+ * Output is extrinsic. Merged stages saturate at different points than
+ * single stages, so L-values differ from the radix-2 recursion once metrics
+ * saturate while hard decisions are unaffected.
+ */
+static inline void gen_bw_metrics_r4(const int16_t *bm, const int8_t *z,
+				     int16_t *fw, int16_t *bw,
+				     int16_t norm, int16_t *lv)
+{
+	__m128i m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10;
+
+	m8 = _mm_load_si128((__m128i *) &bm[0]);
+	m9 = _mm_load_si128((__m128i *) &bm[8]);
+	m10 = _mm_setzero_si128();
+
+	/* Interleaved branch metrics - same as radix-2 recursion */
+	m0 = _mm_unpacklo_epi16(m9, _mm_subs_epi16(m10, m9));
+
+	/* Merged branch metrics in successor order */
+	m1 = _mm_set_epi16(R4_BW_SIGN);
+	m2 = _mm_sign_epi16(_mm_unpacklo_epi16(m8, m8), m1);
+	m3 = _mm_sign_epi16(_mm_unpackhi_epi16(m8, m8), m1);
+	m4 = _mm_unpacklo_epi16(m0, m0);
+	m5 = _mm_unpackhi_epi16(m0, m0);
+
+	m6 = _mm_subs_epi16(m2, m4);
+	m7 = _mm_subs_epi16(m3, m5);
+	m4 = _mm_adds_epi16(m4, m2);
+	m5 = _mm_adds_epi16(m5, m3);
+
+	/* Backward metrics */
+	m1 = _mm_load_si128((__m128i *) bw);
+	m2 = _mm_shuffle_epi8(m1, _mm_set_epi8(R4_BW_SUCC_MASK0));
+	m3 = _mm_shuffle_epi8(m1, _mm_set_epi8(R4_BW_SUCC_MASK1));
+	m4 = _mm_adds_epi16(m4, m2);
+	m5 = _mm_adds_epi16(m5, m3);
+	m2 = _mm_shuffle_epi8(m1, _mm_set_epi8(R4_BW_SUCC_MASK2));
+	m3 = _mm_shuffle_epi8(m1, _mm_set_epi8(R4_BW_SUCC_MASK3));
+	m6 = _mm_adds_epi16(m6, m2);
+	m7 = _mm_adds_epi16(m7, m3);
+
+	m2 = _mm_max_epi16(_mm_max_epi16(m4, m5), _mm_max_epi16(m6, m7));
+	m2 = _mm_subs_epi16(m2, _mm_set1_epi16(norm));
+	_mm_store_si128((__m128i *) bw, m2);
+
+	/* Intermediate backward metrics */
+	m4 = _mm_adds_epi16(_mm_unpacklo_epi16(m1, m1), m0);
+	m5 = _mm_subs_epi16(_mm_unpackhi_epi16(m1, m1), m0);
+	m4 = _mm_max_epi16(m4, m5);
+
+	/* Intermediate forward metrics */
+	m0 = _mm_load_si128((__m128i *) fw);
+	m2 = _mm_shuffle_epi8(m0, _mm_set_epi8(FW_SHUFFLE_MASK0));
+	m3 = _mm_shuffle_epi8(m0, _mm_set_epi8(FW_SHUFFLE_MASK1));
+	m2 = _mm_adds_epi16(m2, m8);
+	m3 = _mm_subs_epi16(m3, m8);
+	m2 = _mm_max_epi16(m2, m3);
+	m2 = _mm_subs_epi16(m2, r4_bcast0(m2));
+
+	/* L-values */
+	lv[0] = r4_gen_lval(m0, m4, z[0]);
+	lv[1] = r4_gen_lval(m2, m1, z[1]);
+}
+
+/*
+ * Hard decisions
+ *
+ * Pack the signs of 16 L-values into two bytes with the first value in the
+ * most significant bit. Saturating packs preserve the sign of each value.
+ */
+static inline uint16_t gen_hard_bits(const int16_t *lv)
+{
+	__m128i m0, m1;
+
+	m0 = _mm_loadu_si128((__m128i *) &lv[0]);
+	m1 = _mm_loadu_si128((__m128i *) &lv[8]);
+	m0 = _mm_packs_epi16(m0, m1);
+	m0 = _mm_cmpgt_epi8(m0, _mm_setzero_si128());
+	m0 = _mm_shuffle_epi8(m0, _mm_set_epi8(8, 9, 10, 11, 12, 13, 14, 15,
+					       0, 1, 2, 3, 4, 5, 6, 7));
+
+	return _mm_movemask_epi8(m0);
+}
+
+/* Minimum L-value magnitude over 'n' values with 'n' a multiple of 8 */
+static inline int16_t gen_min_abs(const int16_t *lv, int n)
+{
+	int i;
+	__m128i m0, m1 = _mm_set1_epi16(32767);
+
+	for (i = 0; i < n; i += 8) {
+		m0 = _mm_loadu_si128((__m128i *) &lv[i]);
+		m1 = _mm_min_epi16(m1, _mm_abs_epi16(m0));
+	}
+
+	m0 = _mm_shuffle_epi32(m1, _MM_SHUFFLE(1, 0, 3, 2));
+	m1 = _mm_min_epi16(m1, m0);
+	m0 = _mm_shufflelo_epi16(m1, _MM_SHUFFLE(1, 0, 3, 2));
+	m1 = _mm_min_epi16(m1, m0);
+	m0 = _mm_shufflelo_epi16(m1, _MM_SHUFFLE(2, 3, 0, 1));
+	m1 = _mm_min_epi16(m1, m0);
+
+	return _mm_extract_epi16(m1, 0);
+}
 #else
 static inline int16_t gen_fw_metrics(int16_t *bm, int8_t x, int8_t z,
 		       int16_t *sums_p, int16_t *sums_c, int16_t le)
@@ -224,4 +771,71 @@ static inline int16_t gen_bw_metrics(int16_t *bm, const int8_t z,
 {
 	return 0;
 }
+
+static inline void gen_bw_train(int8_t x, int8_t z, int16_t le, int16_t *bw)
+{
+}
+
+static inline void gen_mod_init(int16_t *sums)
+{
+}
+
+static inline void gen_mod_norm(int16_t *sums)
+{
+}
+
+static inline void gen_fw_metrics_mod(int16_t *bm, int8_t x, int8_t z,
+				      const int16_t *sums_p, int16_t *sums_c,
+				      int16_t le)
+{
+}
+
+static inline int16_t gen_bw_metrics_mod(const int16_t *bm, const int8_t z,
+					 const int16_t *fw, int16_t *bw)
+{
+	return 0;
+}
+
+static inline int16_t gen_fw_metrics_lm(int16_t *bm, int8_t x, int8_t z,
+					int16_t *sums_p, int16_t *sums_c,
+					int16_t le, const int8_t *lut,
+					int shift)
+{
+	return 0;
+}
+
+static inline int16_t gen_bw_metrics_lm(int16_t *bm, const int8_t z,
+					int16_t *fw, int16_t *bw, int16_t norm,
+					const int8_t *lut, int shift)
+{
+	return 0;
+}
+
+static inline int16_t gen_fw_metrics_r4(int16_t *bm, const int8_t *x,
+					const int8_t *z, const int16_t *le,
+					int16_t *sums_p, int16_t *sums_c)
+{
+	return 0;
+}
+
+static inline void gen_bw_metrics_r4(const int16_t *bm, const int8_t *z,
+				     int16_t *fw, int16_t *bw,
+				     int16_t norm, int16_t *lv)
+{
+}
+
+static inline int16_t gen_lval(const int16_t *fw, const int16_t *bw, int8_t z)
+{
+	return 0;
+}
+
+static inline uint16_t gen_hard_bits(const int16_t *lv)
+{
+	return 0;
+}
+
+static inline int16_t gen_min_abs(const int16_t *lv, int n)
+{
+	return 0;
+}
 #endif /* HAVE_SSE3 */
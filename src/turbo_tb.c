@@ -0,0 +1,349 @@
+/*
+ * Turbo decoder pool for transport blocks
+ *
+ * Copyright (C) 2015 Ettus Research LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Tom Tsou <tom.tsou@ettus.com>
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include "turbofec/turbo.h"
+#include "turbo_int.h"
+
+#define API_EXPORT	__attribute__((__visibility__("default")))
+
+/* Code block of transport block 'tb' */
+struct tjob {
+	int tb;
+	int blk;
+	int prio;
+	int len;
+};
+
+/*
+ * Work-stealing deque
+ *
+ * Holds the jobs from 'head' to 'tail'. The owner takes jobs from the head
+ * in priority order while other participants steal from the tail. Jobs are
+ * only added before decoding starts, so a lock held for a few instructions
+ * per code block is sufficient.
+ */
+struct tdeque {
+	pthread_mutex_t lock;
+	int head;
+	int tail;
+};
+
+/*
+ * Decoder Pool
+ *
+ * pool      - Worker threads, participant 0 is the calling thread
+ * num       - Number of participants
+ * dec       - Decoder of each participant
+ * deque     - Job deque of each participant
+ * jobs      - Jobs grouped by deque, followed by sorting space
+ * num_jobs  - Number of allocated jobs
+ * left      - Remaining code blocks of each transport block
+ * num_tb    - Number of allocated transport block counters
+ * tb        - Transport blocks of the current call
+ * err       - Decoding error of the current call
+ */
+struct tdec_pool {
+	struct tpool *pool;
+	int num;
+	struct tdecoder **dec;
+	struct tdeque *deque;
+	struct tjob *jobs;
+	int num_jobs;
+	int *left;
+	int num_tb;
+	struct lte_turbo_tb *tb;
+	int err;
+};
+
+/* Higher priority first, then longer code blocks, then submission order */
+static int cmp_job(const void *a, const void *b)
+{
+	const struct tjob *j0 = (const struct tjob *) a;
+	const struct tjob *j1 = (const struct tjob *) b;
+
+	if (j0->prio != j1->prio)
+		return j1->prio - j0->prio;
+	if (j0->len != j1->len)
+		return j1->len - j0->len;
+	if (j0->tb != j1->tb)
+		return j0->tb - j1->tb;
+
+	return j0->blk - j1->blk;
+}
+
+/* Take a job from the own deque or steal one, returns -1 when none is left */
+static int take_job(struct tdec_pool *pool, int idx)
+{
+	int i, j = -1;
+	struct tdeque *dq = &pool->deque[idx];
+
+	pthread_mutex_lock(&dq->lock);
+	if (dq->head < dq->tail)
+		j = dq->head++;
+	pthread_mutex_unlock(&dq->lock);
+
+	for (i = 1; (j < 0) && (i < pool->num); i++) {
+		dq = &pool->deque[(idx + i) % pool->num];
+
+		pthread_mutex_lock(&dq->lock);
+		if (dq->head < dq->tail)
+			j = --dq->tail;
+		pthread_mutex_unlock(&dq->lock);
+	}
+
+	return j;
+}
+
+static void run_job(struct tdec_pool *pool, int idx, const struct tjob *job)
+{
+	int rc, err = 0;
+	struct lte_turbo_tb *tb = &pool->tb[job->tb];
+	struct lte_turbo_tti_block *blk = &tb->blk[job->blk];
+
+	rc = tdec_decode_block(pool->dec[idx], tb->iter, blk);
+	if (rc < 0) {
+		blk->iter = 0;
+		blk->status = TDEC_BLOCK_MAX_ITER;
+		__atomic_compare_exchange_n(&pool->err, &err, rc, 0,
+					    __ATOMIC_RELAXED,
+					    __ATOMIC_RELAXED);
+	}
+
+	if (blk->status != TDEC_BLOCK_CONVERGED)
+		__atomic_add_fetch(&tb->failed, 1, __ATOMIC_RELAXED);
+
+	if (!__atomic_sub_fetch(&pool->left[job->tb], 1, __ATOMIC_ACQ_REL) &&
+	    tb->done)
+		tb->done(tb, tb->arg);
+}
+
+static void tb_job(void *arg, int idx)
+{
+	int j;
+	struct tdec_pool *pool = (struct tdec_pool *) arg;
+
+	while ((j = take_job(pool, idx)) >= 0)
+		run_job(pool, idx, &pool->jobs[j]);
+}
+
+/*
+ * Sort jobs into the sorting space and deal them to the deques in turn, so
+ * that every deque starts with the highest priority and longest blocks.
+ */
+static void deal_jobs(struct tdec_pool *pool, int total)
+{
+	int i, j, n = 0;
+	struct tjob *sorted = &pool->jobs[total];
+
+	qsort(sorted, total, sizeof(struct tjob), cmp_job);
+
+	for (i = 0; i < pool->num; i++) {
+		pool->deque[i].head = n;
+
+		for (j = i; j < total; j += pool->num)
+			pool->jobs[n++] = sorted[j];
+
+		pool->deque[i].tail = n;
+	}
+}
+
+static int alloc_jobs(struct tdec_pool *pool, int n, int total)
+{
+	void *ptr;
+
+	if (total > pool->num_jobs) {
+		ptr = realloc(pool->jobs, 2 * total * sizeof(struct tjob));
+		if (!ptr)
+			return -ENOMEM;
+		pool->jobs = (struct tjob *) ptr;
+		pool->num_jobs = total;
+	}
+
+	if (n > pool->num_tb) {
+		ptr = realloc(pool->left, n * sizeof(int));
+		if (!ptr)
+			return -ENOMEM;
+		pool->left = (int *) ptr;
+		pool->num_tb = n;
+	}
+
+	return 0;
+}
+
+API_EXPORT
+int lte_turbo_decode_tb(struct tdec_pool *pool, int n,
+			struct lte_turbo_tb *tb)
+{
+	int i, j, rc, total = 0, failed = 0;
+	struct tjob *job;
+
+	if (n < 0)
+		return -EINVAL;
+
+	for (i = 0; i < n; i++) {
+		if ((tb[i].num < 0) || (tb[i].iter < 0))
+			return -EINVAL;
+
+		for (j = 0; j < tb[i].num; j++) {
+			if ((tb[i].blk[j].len < TURBO_MIN_K) ||
+			    (tb[i].blk[j].len > TURBO_MAX_K))
+				return -EINVAL;
+		}
+
+		total += tb[i].num;
+	}
+
+	/* Nothing to decode, complete empty transport blocks only */
+	if (!total) {
+		for (i = 0; i < n; i++) {
+			tb[i].failed = 0;
+			if (tb[i].done)
+				tb[i].done(&tb[i], tb[i].arg);
+		}
+
+		return 0;
+	}
+
+	rc = alloc_jobs(pool, n, total);
+	if (rc < 0)
+		return rc;
+
+	job = &pool->jobs[total];
+
+	for (i = 0; i < n; i++) {
+		tb[i].failed = 0;
+		pool->left[i] = tb[i].num;
+
+		for (j = 0; j < tb[i].num; j++) {
+			job->tb = i;
+			job->blk = j;
+			job->prio = tb[i].prio;
+			job->len = tb[i].blk[j].len;
+			job++;
+		}
+	}
+
+	deal_jobs(pool, total);
+
+	pool->tb = tb;
+	pool->err = 0;
+
+	tpool_run(pool->pool, tb_job, pool);
+
+	for (i = 0; i < n; i++) {
+		if (!tb[i].num && tb[i].done)
+			tb[i].done(&tb[i], tb[i].arg);
+
+		failed += tb[i].failed;
+	}
+
+	return pool->err ? pool->err : failed;
+}
+
+API_EXPORT
+int tdec_pool_set_opt(struct tdec_pool *pool, int opt, int val)
+{
+	int i, rc;
+
+	if (((opt == TDEC_OPT_PARALLEL) && (val != 1)) ||
+	    ((opt == TDEC_OPT_SHUFFLE) && val))
+		return -EINVAL;
+
+	for (i = 0; i < pool->num; i++) {
+		rc = tdec_set_opt(pool->dec[i], opt, val);
+		if (rc < 0)
+			return rc;
+	}
+
+	return 0;
+}
+
+API_EXPORT
+void free_tdec_pool(struct tdec_pool *pool)
+{
+	int i;
+
+	if (!pool)
+		return;
+
+	free_tpool(pool->pool);
+
+	for (i = 0; i < pool->num; i++) {
+		free_tdec(pool->dec[i]);
+		pthread_mutex_destroy(&pool->deque[i].lock);
+	}
+
+	free(pool->dec);
+	free(pool->deque);
+	free(pool->jobs);
+	free(pool->left);
+	free(pool);
+}
+
+/* Allocate pool of 'num' threads including the calling thread */
+API_EXPORT
+struct tdec_pool *alloc_tdec_pool(int num)
+{
+	int i;
+	struct tdec_pool *pool;
+
+	if (num < 1)
+		return NULL;
+
+	pool = (struct tdec_pool *) calloc(1, sizeof(struct tdec_pool));
+	if (!pool)
+		return NULL;
+
+	pool->dec = (struct tdecoder **) calloc(num, sizeof(*pool->dec));
+	pool->deque = (struct tdeque *) calloc(num, sizeof(*pool->deque));
+	if (!pool->dec || !pool->deque) {
+		free(pool->dec);
+		free(pool->deque);
+		free(pool);
+		return NULL;
+	}
+
+	pool->num = num;
+
+	/* Locks are destroyed for all deques on failure */
+	for (i = 0; i < num; i++)
+		pthread_mutex_init(&pool->deque[i].lock, NULL);
+
+	for (i = 0; i < num; i++) {
+		pool->dec[i] = alloc_tdec();
+		if (!pool->dec[i])
+			goto fail;
+	}
+
+	pool->pool = alloc_tpool(num);
+	if (!pool->pool)
+		goto fail;
+
+	return pool;
+fail:
+	free_tdec_pool(pool);
+	return NULL;
+}
@@ -0,0 +1,196 @@
+/*
+ * Turbo decoder worker threads
+ *
+ * Copyright (C) 2015 Ettus Research LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Tom Tsou <tom.tsou@ettus.com>
+ */
+
+#include <stdlib.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include "turbofec/turbo.h"
+#include "turbo_int.h"
+
+/*
+ * Number of times a thread yields at a barrier before blocking. Barriers are
+ * passed at every half-iteration, so briefly spinning avoids the wake-up
+ * latency of the condition variable on an otherwise idle core.
+ */
+#define BARRIER_SPIN		64
+
+struct tpool;
+
+/* Worker thread argument */
+struct tworker {
+	struct tpool *pool;
+	pthread_t thread;
+	int idx;
+};
+
+/*
+ * Thread Pool
+ *
+ * num      - Number of participants including the calling thread
+ * count    - Number of participants waiting at the barrier
+ * gen      - Barrier generation, incremented on each release
+ * func     - Job function run on all participants
+ * arg      - Job function argument
+ * quit     - Exit flag for worker threads
+ * workers  - Worker threads (num - 1)
+ */
+struct tpool {
+	int num;
+	int count;
+	unsigned gen;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+
+	void (*func)(void *arg, int idx);
+	void *arg;
+	int quit;
+
+	struct tworker *workers;
+};
+
+/*
+ * Barrier for all participants of the pool. The last thread to arrive
+ * resets the count before advancing the generation, so threads passing
+ * through can immediately enter the next barrier.
+ */
+void tpool_barrier(struct tpool *pool)
+{
+	int i;
+	unsigned gen = __atomic_load_n(&pool->gen, __ATOMIC_ACQUIRE);
+
+	if (__atomic_add_fetch(&pool->count, 1, __ATOMIC_ACQ_REL) == pool->num) {
+		__atomic_store_n(&pool->count, 0, __ATOMIC_RELAXED);
+
+		pthread_mutex_lock(&pool->lock);
+		__atomic_store_n(&pool->gen, gen + 1, __ATOMIC_RELEASE);
+		pthread_cond_broadcast(&pool->cond);
+		pthread_mutex_unlock(&pool->lock);
+		return;
+	}
+
+	for (i = 0; i < BARRIER_SPIN; i++) {
+		if (__atomic_load_n(&pool->gen, __ATOMIC_ACQUIRE) != gen)
+			return;
+		sched_yield();
+	}
+
+	pthread_mutex_lock(&pool->lock);
+	while (__atomic_load_n(&pool->gen, __ATOMIC_ACQUIRE) == gen)
+		pthread_cond_wait(&pool->cond, &pool->lock);
+	pthread_mutex_unlock(&pool->lock);
+}
+
+static void *tpool_thread(void *ptr)
+{
+	struct tworker *worker = (struct tworker *) ptr;
+	struct tpool *pool = worker->pool;
+
+	for (;;) {
+		tpool_barrier(pool);
+		if (pool->quit)
+			break;
+
+		pool->func(pool->arg, worker->idx);
+		tpool_barrier(pool);
+	}
+
+	return NULL;
+}
+
+/*
+ * Run job function on all participants
+ *
+ * The calling thread runs index 0. Returns after all participants have
+ * completed the job.
+ */
+void tpool_run(struct tpool *pool, void (*func)(void *arg, int idx), void *arg)
+{
+	pool->func = func;
+	pool->arg = arg;
+
+	tpool_barrier(pool);
+	func(arg, 0);
+	tpool_barrier(pool);
+}
+
+int tpool_size(const struct tpool *pool)
+{
+	return pool->num;
+}
+
+void free_tpool(struct tpool *pool)
+{
+	int i;
+
+	if (!pool)
+		return;
+
+	pool->quit = 1;
+	tpool_barrier(pool);
+
+	for (i = 0; i < pool->num - 1; i++)
+		pthread_join(pool->workers[i].thread, NULL);
+
+	pthread_cond_destroy(&pool->cond);
+	pthread_mutex_destroy(&pool->lock);
+	free(pool->workers);
+	free(pool);
+}
+
+/* Allocate pool of 'num' participants with 'num - 1' worker threads */
+struct tpool *alloc_tpool(int num)
+{
+	int i;
+	struct tpool *pool;
+
+	if (num < 1)
+		return NULL;
+
+	pool = (struct tpool *) calloc(1, sizeof(struct tpool));
+	if (!pool)
+		return NULL;
+
+	pool->workers = (struct tworker *) calloc(num, sizeof(struct tworker));
+	if (!pool->workers) {
+		free(pool);
+		return NULL;
+	}
+
+	pool->num = num;
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->cond, NULL);
+
+	for (i = 0; i < num - 1; i++) {
+		pool->workers[i].pool = pool;
+		pool->workers[i].idx = i + 1;
+
+		if (pthread_create(&pool->workers[i].thread, NULL,
+				   tpool_thread, &pool->workers[i])) {
+			/* Shrink to the threads that were started */
+			pool->num = i + 1;
+			free_tpool(pool);
+			return NULL;
+		}
+	}
+
+	return pool;
+}
@@ -8,6 +8,8 @@
 #include <sched.h>
 
 #include "noise.h"
+#include "turbofec/crc.h"
+#include "turbofec/segment.h"
 #include "turbofec/turbo.h"
 
 #define MAX_LEN_BITS		32768
@@ -17,6 +19,21 @@
 #define DEFAULT_THREADS		1
 #define MAX_THREADS		32
 
+/* Number of code blocks in batch decoding tests, full and half filled */
+#define BATCH_SIZE		20
+#define BATCH_HALF		12
+
+/* Number of code blocks in TTI decoding tests */
+#define TTI_SIZE		4
+
+/* Transport blocks and threads in decoder pool tests */
+#define NUM_TB			3
+#define MAX_TB_BLOCKS		4
+#define TB_THREADS		3
+
+/* Frame errors allowed for decoder modes above the default decoder */
+#define MODE_FER_MARGIN(N)	((N) / 20 + 1)
+
 /* Maximum LTE code block size of 6144 */
 #define LEN		TURBO_MAX_K
 
@@ -27,192 +44,1373 @@
  * which has a valid range from 0 (no signal) to 127 (saturation).
  */
 #define DEFAULT_SNR	8.0
+#define NOISE_FREE_SNR	100.0
 #define DEFAULT_AMP	32.0
 
-/*
- * Command line arguments
- *
- * iter     - Number of iterations
- * threads  - Number of concurrent threads to launch for benchmark test
- * bench    - Enable the benchmarking test
- * length   - Enable length checks
- * ber      - Enable the bit-error-rate test
- * num      - Run code number if specified 
- */
-struct cmd_options {
-	int num_pkts;
-	int iter;
-	int threads;
-	int bench;
-	int length;
-	int num;
-	int ber;
-	float snr;
-};
+/*
+ * Command line arguments
+ *
+ * iter     - Number of iterations
+ * threads  - Number of concurrent threads to launch for benchmark test
+ * bench    - Enable the benchmarking test
+ * length   - Enable length checks
+ * ber      - Enable the bit-error-rate test
+ * num      - Run code number if specified 
+ */
+struct cmd_options {
+	int num_pkts;
+	int iter;
+	int threads;
+	int bench;
+	int length;
+	int num;
+	int ber;
+	float snr;
+};
+
+/* Argument passing struct for benchmark threads */
+struct benchmark_thread_arg {
+	const struct lte_test_vector *test;
+	const struct lte_turbo_code *code;
+	struct tdecoder *tdec;
+	int base;
+	int num_pkts;
+	int iter;
+	int err;
+};
+
+const struct lte_turbo_code lte_turbo = {
+	.n = 2,
+	.k = 4,
+	.len = LEN,
+	.rgen = 013,
+	.gen = 015,
+};
+
+struct lte_test_vector {
+	const char *name;
+	const char *spec;
+	const struct lte_turbo_code *code;
+	int in_len;
+	int out_len;
+};
+
+const struct lte_test_vector tests[] = {
+	{
+		.name = "3GPP LTE turbo",
+		.spec = "(N=2, K=4)",
+		.code = &lte_turbo,
+		.in_len  = LEN,
+		.out_len = LEN * 3 + 4 * 3,
+	},
+	{ /* end */ },
+};
+
+/*
+ * Decoder modes
+ *
+ * Additional decoder configurations exercised by the BER test. Each mode
+ * sets a single decoder option on top of the defaults, after the window
+ * length 'win' for options that require windowed recursions.
+ */
+struct decoder_mode {
+	const char *name;
+	int opt;
+	int val;
+	int win;
+};
+
+const struct decoder_mode modes[] = {
+	{
+		.name = "radix-4",
+		.opt = TDEC_OPT_KERNEL,
+		.val = TDEC_KERNEL_RADIX4,
+	},
+	{
+		.name = "8-bit",
+		.opt = TDEC_OPT_KERNEL,
+		.val = TDEC_KERNEL_INT8,
+	},
+	{
+		.name = "sliding window",
+		.opt = TDEC_OPT_WINDOW,
+		.val = 64,
+	},
+	{
+		.name = "parallel",
+		.opt = TDEC_OPT_PARALLEL,
+		.val = 4,
+	},
+	{
+		.name = "agreement stopping",
+		.opt = TDEC_OPT_AGREE,
+		.val = 1,
+	},
+	{
+		.name = "scaled extrinsic",
+		.opt = TDEC_OPT_SCALE,
+		.val = 13,
+	},
+	{
+		.name = "log-MAP",
+		.opt = TDEC_OPT_KERNEL,
+		.val = TDEC_KERNEL_LOGMAP,
+	},
+	{
+		.name = "X-schedule",
+		.opt = TDEC_OPT_KERNEL,
+		.val = TDEC_KERNEL_XSCHED,
+	},
+	{
+		.name = "modulo normalization",
+		.opt = TDEC_OPT_KERNEL,
+		.val = TDEC_KERNEL_MODULO,
+	},
+	{
+		.name = "shuffled",
+		.opt = TDEC_OPT_SHUFFLE,
+		.val = 1,
+		.win = 64,
+	},
+	{
+		.name = "8-bit L-value exchange",
+		.opt = TDEC_OPT_LVAL8,
+		.val = 8,
+	},
+	{
+		.name = "mixed precision",
+		.opt = TDEC_OPT_INT8_ITER,
+		.val = 2,
+	},
+	{ /* end */ },
+};
+
+static void print_codes()
+{
+	int i = 1;
+	const struct lte_test_vector *test;
+
+	printf("\n");
+	printf("Code  0:  Test all codes\n");
+	for (test=tests; test->name; test++)
+		printf("Code %2i:  %-18s %s\n", i++, test->name, test->spec);
+	printf("\n");
+}
+
+static void fill_random(uint8_t *b, int n)
+{
+	int i, r, m, c;
+
+	c = 0;
+	r = rand();
+	m = sizeof(int) - 1;
+
+	for (i = 0; i < n; i++) {
+		if (c++ == m) {
+			r = rand();
+			c = 0;
+		}
+
+		b[i] = (r >> (i % m)) & 0x01;
+	}
+}
+
+/* Generate soft bits with ~2.3% crossover probability */
+static int uint8_to_err(int8_t *dst, uint8_t *src, int n, float snr)
+{
+	int i, err = 0;
+
+	add_noise(src, dst, n, snr, DEFAULT_AMP);
+
+	for (i = 0; i < n; i++) {
+		if ((!src[i] && (dst[i] >= 0)) || (src[i] && (dst[i] <= 0)))
+			err++;
+	}
+
+	return err;
+}
+
+/* Output error input/output error rates */
+static void print_error_results(const struct lte_test_vector *test,
+				int iber, int ober, int fer, int num_pkts)
+{
+	printf("[..] Input BER.......................... %f\n",
+	       (float) iber / (num_pkts * test->out_len));
+	printf("[..] Output BER......................... %f\n",
+	       (float) ober / (num_pkts * test->in_len));
+	printf("[..] Output FER......................... %f\n",
+	       (float) fer / num_pkts);
+}
+
+/* Timed performance benchmark */
+static double get_timed_results(struct timeval *tv0, struct timeval *tv1,
+			        const struct lte_test_vector *test,
+				int num_pkts, int threads)
+{
+	double elapsed;
+
+	elapsed = (tv1->tv_sec - tv0->tv_sec);
+	elapsed += (tv1->tv_usec - tv0->tv_usec) / 1e6;
+	printf("[..] Elapsed time....................... %f secs\n", elapsed);
+	printf("[..] Rate............................... %f Mbps\n",
+	       (float) threads * test->in_len * num_pkts / elapsed / 1e6);
+
+	return elapsed;
+}
+
+/*
+ * Bit error rate test - default decoder configuration if mode is NULL.
+ * Returns the number of frame errors or a negative value on failure.
+ */
+static int error_test(const struct lte_test_vector *test,
+		      const struct decoder_mode *mode,
+		      int num_pkts, int iter, float snr)
+{
+	int i, n, l, iber = 0, ober = 0, fer = 0;
+	int8_t *bs0, *bs1, *bs2;
+	uint8_t *in, *bu0, *bu1, *bu2;
+
+	in  = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bu0 = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bu1 = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bu2 = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bs0 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+	bs1 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+	bs2 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+
+	struct tdecoder *tdec = alloc_tdec();
+
+	if (mode && mode->win &&
+	    (tdec_set_opt(tdec, TDEC_OPT_WINDOW, mode->win) < 0)) {
+		printf("ERROR !\n");
+		fprintf(stderr, "[!] Failed to set decoder window\n");
+		return -1;
+	}
+
+	if (mode && (tdec_set_opt(tdec, mode->opt, mode->val) < 0)) {
+		printf("ERROR !\n");
+		fprintf(stderr, "[!] Failed to set decoder mode\n");
+		return -1;
+	}
+
+	for (i = 0; i < num_pkts; i++) {
+		fill_random(in, test->in_len);
+		l = lte_turbo_encode(test->code, in, bu0, bu1, bu2);
+		if (l != test->out_len) {
+			printf("ERROR !\n");
+			fprintf(stderr, "[!] Failed encoding length check (%i)\n",
+				l);
+			return -1;
+		}
+
+		iber += uint8_to_err(bs0, bu0, LEN + 4, snr);
+		iber += uint8_to_err(bs1, bu1, LEN + 4, snr);
+		iber += uint8_to_err(bs2, bu2, LEN + 4, snr);
+
+		lte_turbo_decode_unpack(tdec, LEN, iter, bu0, bs0, bs1, bs2);
+
+	        for (n = 0; n < test->in_len; n++) {
+			if (in[n] != bu0[n])
+				ober++;
+		}
+
+		if (memcmp(in, bu0, test->in_len))
+			fer++;
+	}
+
+	print_error_results(test, iber, ober, fer, num_pkts);
+
+	free_tdec(tdec);
+	free(in);
+	free(bs0);
+	free(bs1);
+	free(bs2);
+	free(bu0);
+	free(bu1);
+	free(bu2);
+
+	return fer;
+}
+
+/* Bit-serial CRC remainder over 'n' unpacked bits */
+static unsigned crc_bits(unsigned poly, int width, const uint8_t *b, int n)
+{
+	int i;
+	unsigned fb, reg = 0, mask = (1 << width) - 1;
+
+	for (i = 0; i < n; i++) {
+		fb = ((reg >> (width - 1)) & 0x01) ^ b[i];
+		reg = (reg << 1) & mask;
+		if (fb)
+			reg ^= poly;
+	}
+
+	return reg;
+}
+
+/* Replace the last 24 bits with CRC24A parity over the preceding bits */
+static void attach_crc24a(uint8_t *b, int n)
+{
+	int i;
+	unsigned reg = crc_bits(0x864cfb, 24, b, n - 24);
+
+	for (i = 0; i < 24; i++)
+		b[n - 24 + i] = (reg >> (23 - i)) & 0x01;
+}
+
+/* CRC types with polynomials and widths of the bit-serial reference */
+static const struct {
+	int type;
+	unsigned poly;
+	int width;
+} crc_types[] = {
+	{ LTE_CRC24A, 0x864cfb, 24 },
+	{ LTE_CRC24B, 0x800063, 24 },
+	{ LTE_CRC16, 0x1021, 16 },
+	{ LTE_CRC8, 0x9b, 8 },
+};
+
+/* Transport block lengths around segmentation boundaries */
+static const int seg_lens[] = {
+	16, 1000, 6120, 6128, 12216, 12224, 75376, 97896,
+};
+
+static void unpack_bytes(const uint8_t *bytes, int len, uint8_t *bits)
+{
+	int i;
+
+	for (i = 0; i < 8 * len; i++)
+		bits[i] = (bytes[i / 8] >> (7 - i % 8)) & 0x01;
+}
+
+/*
+ * CRC routines must match the bit-serial reference, and segmentation must
+ * produce valid code block sizes that reassemble the transport block
+ */
+static int seg_test(void)
+{
+	int i, n, r, len, k, num, err = 0;
+	uint8_t bytes[128], bits[1024];
+	uint8_t *tb, *out, *cb[64];
+	struct lte_segment seg;
+
+	for (i = 0; i < sizeof(crc_types) / sizeof(crc_types[0]); i++) {
+		for (len = 0; len < 100; len++) {
+			for (n = 0; n < len; n++)
+				bytes[n] = rand();
+
+			unpack_bytes(bytes, len, bits);
+			if (lte_crc(crc_types[i].type, bytes, len) !=
+			    crc_bits(crc_types[i].poly, crc_types[i].width,
+				     bits, 8 * len))
+				err++;
+
+			n = lte_crc_attach(crc_types[i].type, bytes, len);
+			if (lte_crc_check(crc_types[i].type, bytes, n) != 1)
+				err++;
+
+			bytes[rand() % n] ^= 1 << (rand() % 8);
+			if (lte_crc_check(crc_types[i].type, bytes, n) != 0)
+				err++;
+		}
+	}
+
+	for (i = 0; i < sizeof(seg_lens) / sizeof(seg_lens[0]); i++) {
+		if (lte_segment_init(&seg, seg_lens[i]) < 0) {
+			err++;
+			continue;
+		}
+
+		/* Segmented length covers the transport block and all CRCs */
+		len = seg_lens[i] + 24 + (seg.num > 1 ? 24 * seg.num : 0);
+		num = 0;
+
+		for (r = 0; r < seg.num; r++) {
+			k = lte_segment_len(&seg, r);
+			if ((k < TURBO_MIN_K) || (k > TURBO_MAX_K) || (k % 8))
+				err++;
+			num += k;
+		}
+		if ((num - seg.filler != len) || (seg.filler < 0))
+			err++;
+
+		tb = malloc(seg_lens[i] / 8);
+		out = malloc(seg_lens[i] / 8);
+		for (n = 0; n < seg_lens[i] / 8; n++)
+			tb[n] = rand();
+		for (r = 0; r < seg.num; r++)
+			cb[r] = malloc(TURBO_MAX_K / 8);
+
+		lte_segment(&seg, tb, cb);
+
+		for (r = 0; (seg.num > 1) && (r < seg.num); r++) {
+			k = lte_segment_len(&seg, r) / 8;
+			if (lte_crc_check(LTE_CRC24B, cb[r], k) != 1)
+				err++;
+		}
+
+		if ((lte_desegment(&seg, (const uint8_t **) cb, out) != 1) ||
+		    memcmp(tb, out, seg_lens[i] / 8))
+			err++;
+
+		cb[seg.num / 2][seg.filler / 8 + 1] ^= 0x10;
+		if (lte_desegment(&seg, (const uint8_t **) cb, out) != 0)
+			err++;
+
+		for (r = 0; r < seg.num; r++)
+			free(cb[r]);
+		free(tb);
+		free(out);
+	}
+
+	printf("[..] Segmentation and CRC mismatches.... %i\n", err);
+
+	if (err) {
+		printf("ERROR !\n");
+		fprintf(stderr, "[!] Segmentation or CRC mismatch\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Early termination must not stop on a failed code block and should not
+ * exceed the iteration count of full decoding
+ */
+static int crc_test(const struct lte_test_vector *test,
+		    int num_pkts, int iter, float snr)
+{
+	int i, rc, used = 0, fer = 0, err = 0;
+	int8_t *bs0, *bs1, *bs2;
+	uint8_t *in, *bu0, *bu1, *bu2;
+	struct tdecoder *tdec;
+
+	in  = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bu0 = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bu1 = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bu2 = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bs0 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+	bs1 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+	bs2 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+
+	tdec = alloc_tdec();
+	tdec_set_opt(tdec, TDEC_OPT_CRC, TDEC_CRC_24A);
+
+	for (i = 0; i < num_pkts; i++) {
+		fill_random(in, test->in_len);
+		attach_crc24a(in, test->in_len);
+		lte_turbo_encode(test->code, in, bu0, bu1, bu2);
+
+		uint8_to_err(bs0, bu0, LEN + 4, snr);
+		uint8_to_err(bs1, bu1, LEN + 4, snr);
+		uint8_to_err(bs2, bu2, LEN + 4, snr);
+
+		rc = lte_turbo_decode_unpack(tdec, LEN, iter,
+					     bu0, bs0, bs1, bs2);
+		if ((rc < 1) || (rc > iter)) {
+			err++;
+			continue;
+		}
+
+		used += rc;
+
+		if (memcmp(in, bu0, test->in_len)) {
+			fer++;
+			if (rc < iter)
+				err++;
+		}
+	}
+
+	printf("[..] Output FER......................... %f\n",
+	       (float) fer / num_pkts);
+	printf("[..] Average iterations................. %f\n",
+	       (float) used / num_pkts);
+
+	free_tdec(tdec);
+	free(in);
+	free(bs0);
+	free(bs1);
+	free(bs2);
+	free(bu0);
+	free(bu1);
+	free(bu2);
+
+	if (err) {
+		printf("ERROR !\n");
+		fprintf(stderr, "[!] Early termination failed\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Shuffled decoding requires a window. Output depends on thread timing, so
+ * instead of matching serial decoding, every early stop must be correct and
+ * the frame error rate must stay close to serial decoding with the same
+ * window.
+ */
+static int shuffle_test(const struct lte_test_vector *test,
+			int num_pkts, int iter, float snr)
+{
+	int i, rc, fer = 0, ref_fer = 0, err = 0;
+	int8_t *bs0, *bs1, *bs2;
+	uint8_t *in, *bu0, *bu1, *bu2;
+	struct tdecoder *tdec, *sdec;
+
+	in  = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bu0 = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bu1 = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bu2 = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bs0 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+	bs1 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+	bs2 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+
+	tdec = alloc_tdec();
+	sdec = alloc_tdec();
+
+	if (tdec_set_opt(sdec, TDEC_OPT_SHUFFLE, 1) >= 0)
+		err++;
+
+	tdec_set_opt(tdec, TDEC_OPT_WINDOW, 64);
+	tdec_set_opt(sdec, TDEC_OPT_WINDOW, 64);
+	tdec_set_opt(tdec, TDEC_OPT_CRC, TDEC_CRC_24A);
+	tdec_set_opt(sdec, TDEC_OPT_CRC, TDEC_CRC_24A);
+
+	if (tdec_set_opt(sdec, TDEC_OPT_SHUFFLE, 1) < 0)
+		err++;
+	if (tdec_set_opt(sdec, TDEC_OPT_WINDOW, 0) >= 0)
+		err++;
+
+	for (i = 0; i < num_pkts; i++) {
+		fill_random(in, test->in_len);
+		attach_crc24a(in, test->in_len);
+		lte_turbo_encode(test->code, in, bu0, bu1, bu2);
+
+		uint8_to_err(bs0, bu0, LEN + 4, snr);
+		uint8_to_err(bs1, bu1, LEN + 4, snr);
+		uint8_to_err(bs2, bu2, LEN + 4, snr);
+
+		lte_turbo_decode_unpack(tdec, LEN, iter, bu0, bs0, bs1, bs2);
+		if (memcmp(in, bu0, test->in_len))
+			ref_fer++;
+
+		rc = lte_turbo_decode_unpack(sdec, LEN, iter,
+					     bu0, bs0, bs1, bs2);
+		if ((rc < 1) || (rc > iter)) {
+			err++;
+			continue;
+		}
+
+		if (memcmp(in, bu0, test->in_len)) {
+			fer++;
+			if (rc < iter)
+				err++;
+		}
+	}
+
+	printf("[..] Output FER (shuffled/serial)....... %f / %f\n",
+	       (float) fer / num_pkts, (float) ref_fer / num_pkts);
+
+	if (fer > ref_fer + MODE_FER_MARGIN(num_pkts))
+		err++;
+
+	free_tdec(tdec);
+	free_tdec(sdec);
+	free(in);
+	free(bs0);
+	free(bs1);
+	free(bs2);
+	free(bu0);
+	free(bu1);
+	free(bu2);
+
+	if (err) {
+		printf("ERROR !\n");
+		fprintf(stderr, "[!] Shuffled decoding failed\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Soft output signs must match hard decoding and a-posteriori decisions
+ * should not be worse than the extrinsic decisions
+ */
+static int soft_test(const struct lte_test_vector *test,
+		     int num_pkts, int iter, float snr)
+{
+	int i, n, app_err = 0, ext_err = 0, err = 0;
+	int8_t *bs0, *bs1, *bs2;
+	int16_t *app, *ext;
+	uint8_t *in, *bu0, *bu1, *bu2;
+	struct tdecoder *tdec;
+
+	in  = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bu0 = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bu1 = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bu2 = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bs0 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+	bs1 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+	bs2 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+	app = malloc(sizeof(int16_t) * MAX_LEN_BITS);
+	ext = malloc(sizeof(int16_t) * MAX_LEN_BITS);
+
+	tdec = alloc_tdec();
+
+	for (i = 0; i < num_pkts; i++) {
+		fill_random(in, test->in_len);
+		lte_turbo_encode(test->code, in, bu0, bu1, bu2);
+
+		uint8_to_err(bs0, bu0, LEN + 4, snr);
+		uint8_to_err(bs1, bu1, LEN + 4, snr);
+		uint8_to_err(bs2, bu2, LEN + 4, snr);
+
+		lte_turbo_decode_soft(tdec, LEN, iter, app, ext,
+				      bs0, bs1, bs2);
+		lte_turbo_decode_unpack(tdec, LEN, iter, bu0, bs0, bs1, bs2);
+
+		for (n = 0; n < test->in_len; n++) {
+			if ((ext[n] > 0) != bu0[n])
+				err++;
+			if ((ext[n] > 0) != in[n])
+				ext_err++;
+			if ((app[n] > 0) != in[n])
+				app_err++;
+		}
+	}
+
+	printf("[..] Extrinsic BER...................... %f\n",
+	       (float) ext_err / (num_pkts * test->in_len));
+	printf("[..] A-posteriori BER................... %f\n",
+	       (float) app_err / (num_pkts * test->in_len));
+
+	free_tdec(tdec);
+	free(in);
+	free(bs0);
+	free(bs1);
+	free(bs2);
+	free(bu0);
+	free(bu1);
+	free(bu2);
+	free(app);
+	free(ext);
+
+	if (err || (app_err > ext_err)) {
+		printf("ERROR !\n");
+		fprintf(stderr, "[!] Soft output mismatch\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Known filler bits, sent without systematic and first parity values, must
+ * be output as given and should not leave more frame errors than decoding
+ * without them
+ */
+static int known_test(const struct lte_test_vector *test,
+		      int num_pkts, int iter, float snr)
+{
+	int i, n, fer = 0, known_fer = 0, err = 0;
+	int filler = (test->in_len / 8) & ~7;
+	int8_t *bs0, *bs1, *bs2;
+	uint8_t *in, *bu0, *bu1, *bu2;
+	struct tdecoder *tdec, *tdec_known;
+
+	in  = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bu0 = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bu1 = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bu2 = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bs0 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+	bs1 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+	bs2 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+
+	tdec = alloc_tdec();
+	tdec_known = alloc_tdec();
+	if (tdec_set_known(tdec_known, 0, filler, NULL) < 0)
+		err++;
+
+	for (i = 0; i < num_pkts; i++) {
+		fill_random(in, test->in_len);
+		memset(in, 0, filler);
+		lte_turbo_encode(test->code, in, bu0, bu1, bu2);
+
+		uint8_to_err(bs0, bu0, LEN + 4, snr);
+		uint8_to_err(bs1, bu1, LEN + 4, snr);
+		uint8_to_err(bs2, bu2, LEN + 4, snr);
+		memset(bs0, 0, filler);
+		memset(bs1, 0, filler);
+
+		lte_turbo_decode_unpack(tdec, LEN, iter, bu0, bs0, bs1, bs2);
+		if (memcmp(&in[filler], &bu0[filler], test->in_len - filler))
+			fer++;
+
+		lte_turbo_decode_unpack(tdec_known, LEN, iter,
+					bu0, bs0, bs1, bs2);
+		if (memcmp(&in[filler], &bu0[filler], test->in_len - filler))
+			known_fer++;
+
+		for (n = 0; n < filler; n++) {
+			if (bu0[n])
+				err++;
+		}
+	}
+
+	printf("[..] Output FER (known/unknown)......... %f / %f\n",
+	       (float) known_fer / num_pkts, (float) fer / num_pkts);
+
+	free_tdec(tdec);
+	free_tdec(tdec_known);
+	free(in);
+	free(bs0);
+	free(bs1);
+	free(bs2);
+	free(bu0);
+	free(bu1);
+	free(bu2);
+
+	if (err || (known_fer > fer)) {
+		printf("ERROR !\n");
+		fprintf(stderr, "[!] Known bit decoding failed\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Chase combining of a retransmission, saturated to the soft bit range */
+static void combine_soft(int8_t *dst, const int8_t *src, int n)
+{
+	int i, v;
+
+	for (i = 0; i < n; i++) {
+		v = dst[i] + src[i];
+		dst[i] = v > 127 ? 127 : (v < -127 ? -127 : v);
+	}
+}
+
+/*
+ * Warm started decoding from zero must match regular decoding, and
+ * retransmissions continuing from the saved L-values should not take more
+ * iterations than decoding the combined inputs from scratch. Decoding that
+ * stops after the first constituent decoder of the first iteration must
+ * leave the initial L-values in place.
+ */
+static int harq_test(const struct lte_test_vector *test,
+		     int num_pkts, int iter, float snr)
+{
+	int i, n, rc0, rc1, warm = 0, cold = 0, warm_fer = 0, cold_fer = 0;
+	int err = 0;
+	int8_t *bs0, *bs1, *bs2, *rs0, *rs1, *rs2;
+	int16_t *lvals;
+	uint8_t *in, *bu0, *bu1, *bu2, *out0, *out1;
+	struct tdecoder *tdec, *tdec_crc;
+
+	in  = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bu0 = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bu1 = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bu2 = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bs0 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+	bs1 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+	bs2 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+	rs0 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+	rs1 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+	rs2 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+	out0 = malloc(sizeof(uint8_t) * MAX_LEN_BYTES);
+	out1 = malloc(sizeof(uint8_t) * MAX_LEN_BYTES);
+	lvals = malloc(sizeof(int16_t) * MAX_LEN_BITS);
+
+	tdec = alloc_tdec();
+	tdec_crc = alloc_tdec();
+	tdec_set_opt(tdec_crc, TDEC_OPT_CRC, TDEC_CRC_24A);
+
+	for (i = 0; i < num_pkts; i++) {
+		fill_random(in, test->in_len);
+		attach_crc24a(in, test->in_len);
+		lte_turbo_encode(test->code, in, bu0, bu1, bu2);
+
+		uint8_to_err(bs0, bu0, LEN + 4, snr);
+		uint8_to_err(bs1, bu1, LEN + 4, snr);
+		uint8_to_err(bs2, bu2, LEN + 4, snr);
+		uint8_to_err(rs0, bu0, LEN + 4, snr);
+		uint8_to_err(rs1, bu1, LEN + 4, snr);
+		uint8_to_err(rs2, bu2, LEN + 4, snr);
+
+		/* First transmission */
+		memset(lvals, 0, sizeof(int16_t) * LEN);
+		rc0 = lte_turbo_decode(tdec, LEN, iter, out0, bs0, bs1, bs2);
+		rc1 = lte_turbo_decode_harq(tdec, LEN, iter, out1, lvals,
+					    bs0, bs1, bs2);
+		if ((rc0 != rc1) || memcmp(out0, out1, LEN / 8))
+			err++;
+
+		/* Retransmission */
+		combine_soft(bs0, rs0, LEN + 4);
+		combine_soft(bs1, rs1, LEN + 4);
+		combine_soft(bs2, rs2, LEN + 4);
+
+		rc0 = lte_turbo_decode_unpack(tdec_crc, LEN, iter,
+					      bu0, bs0, bs1, bs2);
+		cold += rc0;
+		if (memcmp(in, bu0, test->in_len))
+			cold_fer++;
+
+		rc1 = lte_turbo_decode_harq(tdec_crc, LEN, iter, out1, lvals,
+					    bs0, bs1, bs2);
+		warm += rc1;
+		unpack_bytes(out1, LEN / 8, bu0);
+		if (memcmp(in, bu0, test->in_len))
+			warm_fer++;
+	}
+
+	/* Noise free inputs pass the CRC after the first decoder */
+	fill_random(in, test->in_len);
+	attach_crc24a(in, test->in_len);
+	lte_turbo_encode(test->code, in, bu0, bu1, bu2);
+
+	uint8_to_err(bs0, bu0, LEN + 4, NOISE_FREE_SNR);
+	uint8_to_err(bs1, bu1, LEN + 4, NOISE_FREE_SNR);
+	uint8_to_err(bs2, bu2, LEN + 4, NOISE_FREE_SNR);
+
+	memset(lvals, 0, sizeof(int16_t) * LEN);
+	lte_turbo_decode_harq(tdec_crc, LEN, iter, out1, lvals,
+			      bs0, bs1, bs2);
+	for (n = 0; n < LEN; n++) {
+		if (lvals[n])
+			err++;
+	}
+
+	printf("[..] Retransmission FER (warm/cold)..... %f / %f\n",
+	       (float) warm_fer / num_pkts, (float) cold_fer / num_pkts);
+	printf("[..] Average iterations (warm/cold)..... %f / %f\n",
+	       (float) warm / num_pkts, (float) cold / num_pkts);
+
+	free_tdec(tdec);
+	free_tdec(tdec_crc);
+	free(in);
+	free(bs0);
+	free(bs1);
+	free(bs2);
+	free(rs0);
+	free(rs1);
+	free(rs2);
+	free(bu0);
+	free(bu1);
+	free(bu2);
+	free(out0);
+	free(out1);
+	free(lvals);
+
+	if (err || (warm > cold)) {
+		printf("ERROR !\n");
+		fprintf(stderr, "[!] Warm start decoding failed\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Hard decision errors of a-posteriori values of the first constituent code */
+static int siso_errors(const uint8_t *in, const int8_t *x,
+		       const int16_t *ext, int n)
+{
+	int i, err = 0;
+
+	for (i = 0; i < n; i++) {
+		if ((2 * x[i] + ext[i] > 0) != in[i])
+			err++;
+	}
+
+	return err;
+}
+
+/*
+ * A single constituent decoder pass, with and without trellis termination,
+ * must reduce the error rate of the systematic channel values
+ */
+static int siso_test(const struct lte_test_vector *test,
+		     int num_pkts, float snr)
+{
+	int i, iber = 0, term_ber = 0, unterm_ber = 0, err = 0;
+	int8_t *bs0, *bs1, *bs2, *x, *z;
+	int16_t *ext;
+	uint8_t *in, *bu0, *bu1, *bu2;
+	struct tdecoder *tdec;
+
+	in  = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bu0 = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bu1 = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bu2 = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	bs0 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+	bs1 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+	bs2 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+	x = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+	z = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+	ext = malloc(sizeof(int16_t) * MAX_LEN_BITS);
+
+	tdec = alloc_tdec();
+
+	for (i = 0; i < num_pkts; i++) {
+		fill_random(in, test->in_len);
+		lte_turbo_encode(test->code, in, bu0, bu1, bu2);
+
+		iber += uint8_to_err(bs0, bu0, LEN, snr);
+		uint8_to_err(bs1, bu1, LEN, snr);
+		uint8_to_err(bs2 + LEN, bu2 + LEN, 4, snr);
+		uint8_to_err(bs0 + LEN, bu0 + LEN, 4, snr);
+		uint8_to_err(bs1 + LEN, bu1 + LEN, 4, snr);
+
+		/* First encoder tail in trellis order */
+		memcpy(x, bs0, LEN);
+		memcpy(z, bs1, LEN);
+		x[LEN + 0] = bs0[LEN + 0];
+		z[LEN + 0] = bs1[LEN + 0];
+		x[LEN + 1] = bs2[LEN + 0];
+		z[LEN + 1] = bs0[LEN + 1];
+		x[LEN + 2] = bs1[LEN + 1];
+		z[LEN + 2] = bs2[LEN + 1];
+
+		if (lte_turbo_siso(tdec, LEN, 1, x, z, NULL, ext) < 0)
+			err++;
+		term_ber += siso_errors(in, x, ext, LEN);
+
+		if (lte_turbo_siso(tdec, LEN, 0, x, z, NULL, ext) < 0)
+			err++;
+		unterm_ber += siso_errors(in, x, ext, LEN);
+	}
+
+	printf("[..] Input BER.......................... %f\n",
+	       (float) iber / (num_pkts * LEN));
+	printf("[..] Output BER (term/unterm)........... %f / %f\n",
+	       (float) term_ber / (num_pkts * LEN),
+	       (float) unterm_ber / (num_pkts * LEN));
+
+	free_tdec(tdec);
+	free(in);
+	free(bs0);
+	free(bs1);
+	free(bs2);
+	free(bu0);
+	free(bu1);
+	free(bu2);
+	free(x);
+	free(z);
+	free(ext);
+
+	if (err || (term_ber > iber) || (unterm_ber > iber)) {
+		printf("ERROR !\n");
+		fprintf(stderr, "[!] Constituent decoding failed\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Paired decoding must match decoding each code block separately */
+static int pair_test(const struct lte_test_vector *test,
+		     int num_pkts, int iter, float snr)
+{
+	int i, n, m, l, err = 0;
+	int8_t *bs[2][3], *cs[2][3];
+	uint8_t *in, *bu[3], *out[2], *ref[2];
+	struct tdecoder *tdec[2], *pdec;
+	struct lte_turbo_block blk[2];
+
+	in = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	for (m = 0; m < 3; m++)
+		bu[m] = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+
+	for (n = 0; n < 2; n++) {
+		for (m = 0; m < 3; m++) {
+			bs[n][m] = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+			cs[n][m] = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+		}
+		out[n] = malloc(sizeof(uint8_t) * MAX_LEN_BYTES);
+		ref[n] = malloc(sizeof(uint8_t) * MAX_LEN_BYTES);
+		tdec[n] = alloc_tdec();
+	}
+
+	pdec = alloc_tdec();
+
+	for (i = 0; i < num_pkts; i++) {
+		for (n = 0; n < 2; n++) {
+			fill_random(in, test->in_len);
+			l = lte_turbo_encode(test->code, in, bu[0], bu[1], bu[2]);
+			if (l != test->out_len) {
+				printf("ERROR !\n");
+				fprintf(stderr, "[!] Failed encoding length "
+					"check (%i)\n", l);
+				return -1;
+			}
+
+			for (m = 0; m < 3; m++) {
+				uint8_to_err(bs[n][m], bu[m], LEN + 4, snr);
+				memcpy(cs[n][m], bs[n][m], LEN + 4);
+			}
 
-/* Argument passing struct for benchmark threads */
-struct benchmark_thread_arg {
-	const struct lte_test_vector *test;
-	const struct lte_turbo_code *code;
-	struct tdecoder *tdec;
-	int base;
-	int num_pkts;
-	int iter;
-	int err;
-};
+			lte_turbo_decode(tdec[n], LEN, iter, ref[n],
+					 cs[n][0], cs[n][1], cs[n][2]);
 
-const struct lte_turbo_code lte_turbo = {
-	.n = 2,
-	.k = 4,
-	.len = LEN,
-	.rgen = 013,
-	.gen = 015,
-};
+			blk[n].d0 = bs[n][0];
+			blk[n].d1 = bs[n][1];
+			blk[n].d2 = bs[n][2];
+			blk[n].output = out[n];
+		}
 
-struct lte_test_vector {
-	const char *name;
-	const char *spec;
-	const struct lte_turbo_code *code;
-	int in_len;
-	int out_len;
-};
+		if (lte_turbo_decode2(pdec, LEN, iter, blk) != iter)
+			err++;
 
-const struct lte_test_vector tests[] = {
-	{
-		.name = "3GPP LTE turbo",
-		.spec = "(N=2, K=4)",
-		.code = &lte_turbo,
-		.in_len  = LEN,
-		.out_len = LEN * 3 + 4 * 3,
-	},
-	{ /* end */ },
-};
+		for (n = 0; n < 2; n++) {
+			if (memcmp(out[n], ref[n], test->in_len / 8))
+				err++;
+		}
+	}
 
-static void print_codes()
-{
-	int i = 1;
-	const struct lte_test_vector *test;
+	printf("[..] Paired output mismatches........... %i\n", err);
 
-	printf("\n");
-	printf("Code  0:  Test all codes\n");
-	for (test=tests; test->name; test++)
-		printf("Code %2i:  %-18s %s\n", i++, test->name, test->spec);
-	printf("\n");
+	for (n = 0; n < 2; n++) {
+		for (m = 0; m < 3; m++) {
+			free(bs[n][m]);
+			free(cs[n][m]);
+		}
+		free(out[n]);
+		free(ref[n]);
+		free_tdec(tdec[n]);
+	}
+	for (m = 0; m < 3; m++)
+		free(bu[m]);
+	free(in);
+	free_tdec(pdec);
+
+	if (err) {
+		printf("ERROR !\n");
+		fprintf(stderr, "[!] Paired decoder output mismatch\n");
+		return -1;
+	}
+
+	return 0;
 }
 
-static void fill_random(uint8_t *b, int n)
+/* Batch decoding must match decoding each code block separately */
+static int batch_test(const struct lte_test_vector *test,
+		      int num_pkts, int iter, float snr)
 {
-	int i, r, m, c;
+	int i, n, m, l, num, err = 0;
+	int8_t *bs[BATCH_SIZE][3];
+	uint8_t *in, *bu[3], *out[BATCH_SIZE], *ref;
+	struct tdecoder *tdec, *bdec;
+	struct lte_turbo_block blk[BATCH_SIZE];
 
-	c = 0;
-	r = rand();
-	m = sizeof(int) - 1;
+	in = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	ref = malloc(sizeof(uint8_t) * MAX_LEN_BYTES);
+	for (m = 0; m < 3; m++)
+		bu[m] = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
 
-	for (i = 0; i < n; i++) {
-		if (c++ == m) {
-			r = rand();
-			c = 0;
+	for (n = 0; n < BATCH_SIZE; n++) {
+		for (m = 0; m < 3; m++)
+			bs[n][m] = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+		out[n] = malloc(sizeof(uint8_t) * MAX_LEN_BYTES);
+
+		blk[n].d0 = bs[n][0];
+		blk[n].d1 = bs[n][1];
+		blk[n].d2 = bs[n][2];
+		blk[n].output = out[n];
+	}
+
+	tdec = alloc_tdec();
+	bdec = alloc_tdec();
+
+	/* Decoder options do not apply to multiple code block decoding */
+	tdec_set_opt(bdec, TDEC_OPT_KERNEL, TDEC_KERNEL_RADIX4);
+	tdec_set_opt(bdec, TDEC_OPT_SCALE, 13);
+
+	for (i = 0; i < num_pkts; i++) {
+		for (n = 0; n < BATCH_SIZE; n++) {
+			fill_random(in, test->in_len);
+			l = lte_turbo_encode(test->code, in, bu[0], bu[1], bu[2]);
+			if (l != test->out_len) {
+				printf("ERROR !\n");
+				fprintf(stderr, "[!] Failed encoding length "
+					"check (%i)\n", l);
+				return -1;
+			}
+
+			for (m = 0; m < 3; m++)
+				uint8_to_err(bs[n][m], bu[m], LEN + 4, snr);
 		}
 
-		b[i] = (r >> (i % m)) & 0x01;
+		num = i % 2 ? BATCH_HALF : BATCH_SIZE;
+		lte_turbo_decode_batch(bdec, num, LEN, iter, blk);
+
+		for (n = 0; n < num; n++) {
+			lte_turbo_decode(tdec, LEN, iter, ref,
+					 bs[n][0], bs[n][1], bs[n][2]);
+
+			if (memcmp(out[n], ref, test->in_len / 8))
+				err++;
+		}
+	}
+
+	printf("[..] Batch output mismatches............ %i\n", err);
+
+	for (n = 0; n < BATCH_SIZE; n++) {
+		for (m = 0; m < 3; m++)
+			free(bs[n][m]);
+		free(out[n]);
+	}
+	for (m = 0; m < 3; m++)
+		free(bu[m]);
+	free(in);
+	free(ref);
+	free_tdec(tdec);
+	free_tdec(bdec);
+
+	if (err) {
+		printf("ERROR !\n");
+		fprintf(stderr, "[!] Batch decoder output mismatch\n");
+		return -1;
 	}
+
+	return 0;
 }
 
-/* Generate soft bits with ~2.3% crossover probability */
-static int uint8_to_err(int8_t *dst, uint8_t *src, int n, float snr)
+/*
+ * TTI decoding without a budget must match decoding each code block
+ * separately, and must stay within the budget otherwise
+ */
+static int tti_test(const struct lte_test_vector *test,
+		    int num_pkts, int iter, float snr, int crc, int lval8)
 {
-	int i, err = 0;
+	int i, n, m, rc, used, err = 0;
+	int8_t *bs[TTI_SIZE][3];
+	uint8_t *in, *bu[3], *out[TTI_SIZE], *ref;
+	struct tdecoder *tdec, *sdec;
+	struct lte_turbo_tti_block blk[TTI_SIZE];
 
-	add_noise(src, dst, n, snr, DEFAULT_AMP);
+	in = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	ref = malloc(sizeof(uint8_t) * MAX_LEN_BYTES);
+	for (m = 0; m < 3; m++)
+		bu[m] = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
 
-	for (i = 0; i < n; i++) {
-		if ((!src[i] && (dst[i] >= 0)) || (src[i] && (dst[i] <= 0)))
+	for (n = 0; n < TTI_SIZE; n++) {
+		for (m = 0; m < 3; m++)
+			bs[n][m] = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+		out[n] = malloc(sizeof(uint8_t) * MAX_LEN_BYTES);
+
+		blk[n].len = LEN;
+		blk[n].d0 = bs[n][0];
+		blk[n].d1 = bs[n][1];
+		blk[n].d2 = bs[n][2];
+		blk[n].output = out[n];
+	}
+
+	tdec = alloc_tdec();
+	sdec = alloc_tdec();
+	tdec_set_opt(tdec, TDEC_OPT_CRC, crc);
+	tdec_set_opt(sdec, TDEC_OPT_CRC, crc);
+	tdec_set_opt(tdec, TDEC_OPT_LVAL8, lval8);
+	tdec_set_opt(sdec, TDEC_OPT_LVAL8, lval8);
+
+	for (i = 0; i < num_pkts; i++) {
+		for (n = 0; n < TTI_SIZE; n++) {
+			fill_random(in, test->in_len);
+			attach_crc24a(in, test->in_len);
+			lte_turbo_encode(test->code, in, bu[0], bu[1], bu[2]);
+
+			for (m = 0; m < 3; m++)
+				uint8_to_err(bs[n][m], bu[m], LEN + 4, snr);
+		}
+
+		lte_turbo_decode_tti(sdec, TTI_SIZE, iter, 0, 0, blk);
+
+		for (n = 0; n < TTI_SIZE; n++) {
+			rc = lte_turbo_decode(tdec, LEN, iter, ref,
+					      bs[n][0], bs[n][1], bs[n][2]);
+
+			if ((rc != blk[n].iter) ||
+			    memcmp(out[n], ref, test->in_len / 8))
+				err++;
+		}
+
+		used = lte_turbo_decode_tti(sdec, TTI_SIZE, iter,
+					    TTI_SIZE, 0, blk);
+		if ((used < 0) || (used > TTI_SIZE))
 			err++;
 	}
 
-	return err;
+	/* Known bits do not apply to TTI decoding */
+	tdec_set_known(sdec, 0, 1, NULL);
+	if (lte_turbo_decode_tti(sdec, TTI_SIZE, iter, 0, 0, blk) >= 0)
+		err++;
+
+	printf("[..] TTI output mismatches.............. %i\n", err);
+
+	for (n = 0; n < TTI_SIZE; n++) {
+		for (m = 0; m < 3; m++)
+			free(bs[n][m]);
+		free(out[n]);
+	}
+	for (m = 0; m < 3; m++)
+		free(bu[m]);
+	free(in);
+	free(ref);
+	free_tdec(tdec);
+	free_tdec(sdec);
+
+	if (err) {
+		printf("ERROR !\n");
+		fprintf(stderr, "[!] TTI decoder output mismatch\n");
+		return -1;
+	}
+
+	return 0;
 }
 
-/* Output error input/output error rates */
-static void print_error_results(const struct lte_test_vector *test,
-				int iber, int ober, int fer, int num_pkts)
+/* Transport blocks of different code block sizes and priorities */
+static const int tb_len[NUM_TB] = { 6144, 1024, 40 };
+static const int tb_num[NUM_TB] = { 3, 2, 4 };
+static const int tb_prio[NUM_TB] = { 0, 2, 1 };
+
+static void tb_done(struct lte_turbo_tb *tb, void *arg)
 {
-	printf("[..] Input BER.......................... %f\n",
-	       (float) iber / (num_pkts * test->out_len));
-	printf("[..] Output BER......................... %f\n",
-	       (float) ober / (num_pkts * test->in_len));
-	printf("[..] Output FER......................... %f\n",
-	       (float) fer / num_pkts);
+	(*(int *) arg)++;
 }
 
-/* Timed performance benchmark */
-static double get_timed_results(struct timeval *tv0, struct timeval *tv1,
-			        const struct lte_test_vector *test,
-				int num_pkts, int threads)
+/*
+ * Pool decoding must match decoding each code block separately and
+ * complete every transport block exactly once
+ */
+static int tb_test(const struct lte_test_vector *test,
+		   int num_pkts, int iter, float snr)
 {
-	double elapsed;
+	int i, n, m, b, rc, failed, err = 0;
+	int done[NUM_TB];
+	int8_t *bs[NUM_TB][MAX_TB_BLOCKS][3];
+	uint8_t *in, *bu[3], *out[NUM_TB][MAX_TB_BLOCKS], *ref;
+	struct lte_turbo_code code = *test->code;
+	struct lte_turbo_tti_block blk[NUM_TB][MAX_TB_BLOCKS];
+	struct lte_turbo_tb tb[NUM_TB];
+	struct tdecoder *tdec;
+	struct tdec_pool *pool;
 
-	elapsed = (tv1->tv_sec - tv0->tv_sec);
-	elapsed += (tv1->tv_usec - tv0->tv_usec) / 1e6;
-	printf("[..] Elapsed time....................... %f secs\n", elapsed);
-	printf("[..] Rate............................... %f Mbps\n",
-	       (float) threads * test->in_len * num_pkts / elapsed / 1e6);
+	in = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
+	ref = malloc(sizeof(uint8_t) * MAX_LEN_BYTES);
+	for (m = 0; m < 3; m++)
+		bu[m] = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
 
-	return elapsed;
-}
+	for (n = 0; n < NUM_TB; n++) {
+		for (b = 0; b < tb_num[n]; b++) {
+			for (m = 0; m < 3; m++)
+				bs[n][b][m] = malloc(MAX_LEN_BITS);
+			out[n][b] = malloc(sizeof(uint8_t) * MAX_LEN_BYTES);
 
-/* Bit error rate test */
-static int error_test(const struct lte_test_vector *test,
-		      int num_pkts, int iter, float snr)
-{
-	int i, n, l, iber = 0, ober = 0, fer = 0;
-	int8_t *bs0, *bs1, *bs2;
-	uint8_t *in, *bu0, *bu1, *bu2;
+			blk[n][b].len = tb_len[n];
+			blk[n][b].d0 = bs[n][b][0];
+			blk[n][b].d1 = bs[n][b][1];
+			blk[n][b].d2 = bs[n][b][2];
+			blk[n][b].output = out[n][b];
+		}
 
-	in  = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
-	bu0 = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
-	bu1 = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
-	bu2 = malloc(sizeof(uint8_t) * MAX_LEN_BITS);
-	bs0 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
-	bs1 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
-	bs2 = malloc(sizeof(int8_t) * MAX_LEN_BITS);
+		tb[n].num = tb_num[n];
+		tb[n].iter = iter;
+		tb[n].prio = tb_prio[n];
+		tb[n].blk = blk[n];
+		tb[n].done = tb_done;
+		tb[n].arg = &done[n];
+	}
 
-	struct tdecoder *tdec = alloc_tdec();
+	tdec = alloc_tdec();
+	pool = alloc_tdec_pool(TB_THREADS);
+	tdec_set_opt(tdec, TDEC_OPT_CRC, TDEC_CRC_24A);
+	tdec_pool_set_opt(pool, TDEC_OPT_CRC, TDEC_CRC_24A);
+
+	/* Pool decoders run serially */
+	if ((tdec_pool_set_opt(pool, TDEC_OPT_PARALLEL, 2) >= 0) ||
+	    (tdec_pool_set_opt(pool, TDEC_OPT_SHUFFLE, 1) >= 0))
+		err++;
+
+	/* Empty transport blocks complete without any jobs */
+	for (n = 0; n < NUM_TB; n++) {
+		tb[n].num = 0;
+		done[n] = 0;
+	}
+
+	if (lte_turbo_decode_tb(pool, NUM_TB, tb))
+		err++;
+
+	for (n = 0; n < NUM_TB; n++) {
+		if (done[n] != 1)
+			err++;
+		tb[n].num = tb_num[n];
+	}
 
 	for (i = 0; i < num_pkts; i++) {
-		fill_random(in, test->in_len);
-		l = lte_turbo_encode(test->code, in, bu0, bu1, bu2);
-		if (l != test->out_len) {
-			printf("ERROR !\n");
-			fprintf(stderr, "[!] Failed encoding length check (%i)\n",
-				l);
-			return -1;
+		for (n = 0; n < NUM_TB; n++) {
+			code.len = tb_len[n];
+
+			for (b = 0; b < tb_num[n]; b++) {
+				fill_random(in, code.len);
+				attach_crc24a(in, code.len);
+				lte_turbo_encode(&code, in,
+						 bu[0], bu[1], bu[2]);
+
+				for (m = 0; m < 3; m++) {
+					uint8_to_err(bs[n][b][m], bu[m],
+						     code.len + 4, snr);
+				}
+			}
+
+			done[n] = 0;
 		}
 
-		iber += uint8_to_err(bs0, bu0, LEN + 4, snr);
-		iber += uint8_to_err(bs1, bu1, LEN + 4, snr);
-		iber += uint8_to_err(bs2, bu2, LEN + 4, snr);
+		rc = lte_turbo_decode_tb(pool, NUM_TB, tb);
 
-		lte_turbo_decode_unpack(tdec, LEN, iter, bu0, bs0, bs1, bs2);
+		for (n = 0, failed = 0; n < NUM_TB; n++) {
+			if (done[n] != 1)
+				err++;
 
-	        for (n = 0; n < test->in_len; n++) {
-			if (in[n] != bu0[n])
-				ober++;
+			for (b = 0; b < tb_num[n]; b++) {
+				m = lte_turbo_decode(tdec, tb_len[n], iter, ref,
+						     bs[n][b][0], bs[n][b][1],
+						     bs[n][b][2]);
+
+				if ((m != blk[n][b].iter) ||
+				    memcmp(out[n][b], ref, tb_len[n] / 8))
+					err++;
+				if (blk[n][b].status != TDEC_BLOCK_CONVERGED)
+					failed++;
+			}
 		}
 
-		if (memcmp(in, bu0, test->in_len))
-			fer++;
+		if (rc != failed)
+			err++;
 	}
 
-	print_error_results(test, iber, ober, fer, num_pkts);
+	printf("[..] Transport block mismatches......... %i\n", err);
 
+	for (n = 0; n < NUM_TB; n++) {
+		for (b = 0; b < tb_num[n]; b++) {
+			for (m = 0; m < 3; m++)
+				free(bs[n][b][m]);
+			free(out[n][b]);
+		}
+	}
+	for (m = 0; m < 3; m++)
+		free(bu[m]);
 	free(in);
-	free(bs0);
-	free(bs1);
-	free(bs2);
-	free(bu0);
-	free(bu1);
-	free(bu2);
+	free(ref);
+	free_tdec(tdec);
+	free_tdec_pool(pool);
+
+	if (err) {
+		printf("ERROR !\n");
+		fprintf(stderr, "[!] Decoder pool output mismatch\n");
+		return -1;
+	}
 
 	return 0;
 }
@@ -402,8 +1600,9 @@ static void handle_options(int argc, char **argv, struct cmd_options *cmd)
 
 int main(int argc, char *argv[])
 {
-	int cnt = 0;
+	int cnt = 0, fer, mode_fer;
 	const struct lte_test_vector *test;
+	const struct decoder_mode *mode;
 	double elapsed;
 	struct benchmark_thread_arg args[MAX_THREADS * 2];
 	struct cmd_options cmd;
@@ -427,9 +1626,95 @@ int main(int argc, char *argv[])
 		if (cmd.ber) {
 			printf("\n[.] BER test:\n");
 			printf("[..] Testing:\n");
-			if (error_test(test, cmd.num_pkts,
+			fer = error_test(test, NULL, cmd.num_pkts,
+					 cmd.iter, cmd.snr);
+			if (fer < 0)
+				return -1;
+
+			/* Modes must not decode worse than the default */
+			for (mode = modes; mode->name; mode++) {
+				printf("\n[.] BER test (%s):\n", mode->name);
+				printf("[..] Testing:\n");
+				mode_fer = error_test(test, mode, cmd.num_pkts,
+						      cmd.iter, cmd.snr);
+				if (mode_fer < 0)
+					return -1;
+
+				if (mode_fer > fer +
+				    MODE_FER_MARGIN(cmd.num_pkts)) {
+					printf("ERROR !\n");
+					fprintf(stderr, "[!] Decoder mode frame "
+						"error rate above default\n");
+					return -1;
+				}
+			}
+
+			printf("\n[.] Segmentation and CRC test:\n");
+			printf("[..] Testing:\n");
+			if (seg_test() < 0)
+				return -1;
+
+			printf("\n[.] CRC early termination test:\n");
+			printf("[..] Testing:\n");
+			if (crc_test(test, cmd.num_pkts, cmd.iter, cmd.snr) < 0)
+				return -1;
+
+			printf("\n[.] Shuffled decoding test:\n");
+			printf("[..] Testing:\n");
+			if (shuffle_test(test, cmd.num_pkts / 4 + 1,
+					 cmd.iter, cmd.snr) < 0)
+				return -1;
+
+			printf("\n[.] Soft output test:\n");
+			printf("[..] Testing:\n");
+			if (soft_test(test, cmd.num_pkts, cmd.iter, cmd.snr) < 0)
+				return -1;
+
+			printf("\n[.] Known bit test:\n");
+			printf("[..] Testing:\n");
+			if (known_test(test, cmd.num_pkts, cmd.iter, cmd.snr) < 0)
+				return -1;
+
+			printf("\n[.] HARQ warm start test:\n");
+			printf("[..] Testing:\n");
+			if (harq_test(test, cmd.num_pkts, cmd.iter, cmd.snr) < 0)
+				return -1;
+
+			printf("\n[.] Constituent decoder test:\n");
+			printf("[..] Testing:\n");
+			if (siso_test(test, cmd.num_pkts, cmd.snr) < 0)
+				return -1;
+
+			printf("\n[.] Paired decoding test:\n");
+			printf("[..] Testing:\n");
+			if (pair_test(test, cmd.num_pkts / 2 + 1,
+				      cmd.iter, cmd.snr) < 0)
+				return -1;
+
+			printf("\n[.] Batch decoding test:\n");
+			printf("[..] Testing:\n");
+			if (batch_test(test, cmd.num_pkts / BATCH_SIZE + 1,
 				       cmd.iter, cmd.snr) < 0)
 				return -1;
+
+			printf("\n[.] TTI decoding test:\n");
+			printf("[..] Testing:\n");
+			if (tti_test(test, cmd.num_pkts / TTI_SIZE + 1,
+				     cmd.iter, cmd.snr, TDEC_CRC_24A, 0) < 0)
+				return -1;
+
+			printf("\n[.] TTI decoding test "
+			       "(8-bit L-value exchange):\n");
+			printf("[..] Testing:\n");
+			if (tti_test(test, cmd.num_pkts / TTI_SIZE + 1,
+				     cmd.iter, cmd.snr, TDEC_CRC_NONE, 8) < 0)
+				return -1;
+
+			printf("\n[.] Decoder pool test:\n");
+			printf("[..] Testing:\n");
+			if (tb_test(test, cmd.num_pkts / BATCH_SIZE + 1,
+				    cmd.iter, cmd.snr) < 0)
+				return -1;
 		}
 
 		if (!cmd.bench)